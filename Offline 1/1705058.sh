@@ -8,7 +8,7 @@ GetInput(){
 
 	if (($#==0)); 
 	then
-		echo 'Use the script like this: ./1705058.sh Working_Directory(Optional) Input_File_Name'
+		echo 'Use the script like this: ./1705058.sh [-j Jobs] [-m copy|hardlink|symlink|reflink|move] [-i] [-d] [-s] [-t] [-p] Working_Directory(Optional) Input_File_Name'
 		exit -1
 	elif (($#==1)); 
 	then
@@ -56,7 +56,7 @@ GetInput(){
 			done
 		fi
 	else
-		echo 'Use the script like this: ./1705058.sh Working_Directory(Optional, without space) Input_File_Name'
+		echo 'Use the script like this: ./1705058.sh [-j Jobs] [-m copy|hardlink|symlink|reflink|move] [-i] [-d] [-s] [-t] [-p] Working_Directory(Optional, without space) Input_File_Name'
 		exit -1
 	fi	
 	
@@ -76,101 +76,627 @@ GetIgnorableTypes(){
 	fi
 }
 
-#A Function Which Finds all files recursively excluding the files mentioned
+#A Function Which Builds The find Arguments That Classify Every File In One Traversal
+#Each file is reported as four NUL terminated fields: the ignored type it matched(empty when it is kept), size, modification time and path
 CreateFileCommand(){
-	CommandToExecute="find $1 -type f"
-	IgnoredList="find $1 -type f" #Necessary for taking the count of ignored files
+	#The output directory is pruned so that files organized by an earlier run are not picked up again
+	FindArguments=("$1" -type d -samefile "$OutputDirectory" -prune -o -type f)
 	
 	shift
-	ExtensionList=("$@")
+	ExtensionList=()
+	declare -A Listed
+	for each in "$@"
+	do
+		if [[ -z ${Listed[$each]} ]]; #A type listed twice is matched once
+		then
+			Listed[$each]=1
+			ExtensionList+=("$each")
+		fi
+	done
 	NumberOfExtensions=${#ExtensionList[@]}
 	
+	local Format
+	FindArguments+=("(")
+	for each in "${ExtensionList[@]}"
+	do
+		Format="${each//\\/\\\\}" #The type is written by -printf, so its "\" and "%" must not act as escapes
+		Format="${Format//%/%%}"
+		FindArguments+=(-name "*.$each" -printf "$Format\\0%s\\0%T@\\0%p\\0" -o)
+	done
+	FindArguments+=(-printf '\0%s\0%T@\0%p\0' ")") #NUL separated, so any file name survives the pipe
+	
+	#echo "${FindArguments[@]}"
+}
+
+#A Function Which Writes The Ignored File Count To The CSV, And The Placement Mode And Ignored Counts Per Type To The Metadata CSV
+WriteRunSummary(){
+	local IgnoredTotal=0
+	for each in "${ExtensionList[@]}"
+	do
+		IgnoredTotal=$((IgnoredTotal+IgnoredCount[$each]))
+	done
+	
+	echo "ignored, $IgnoredTotal" >> $1
+	
+	#Tells the readers of the csv whether the outputs are copies, links or the moved originals
+	#These are kept out of the count table, where they would look like file types
+	echo "key, value" > "$MetaCSVName"
+	echo "placement_mode, $PlacementMode" >> "$MetaCSVName"
 	for each in "${ExtensionList[@]}"
 	do
-		NewComm=' ! -name '''*.$each''''
-		NewComm2=" -iname *.$each -o -type f"
-		CommandToExecute="$CommandToExecute$NewComm"
-		IgnoredList="$IgnoredList$NewComm2"
+		echo "ignored_$each, $((IgnoredCount[$each]))" >> "$MetaCSVName"
+	done
+}
+
+#A Function For Reading The Options Given Before The Working Directory
+GetOptions(){
+	Jobs=1 #Number of parallel copy workers
+	PlacementMode="copy" #How a file is put into its output folder
+	Incremental=0 #Whether to only process the files changed since the last run
+	Dedupe=0 #Whether files are told apart by their contents instead of their names
+	Streaming=0 #Whether files are placed while find is still running, without keeping a list of them
+	Timing=0 #Whether the time spent in each phase is reported on stderr
+	Progress=0 #Whether progress lines and a final summary line are printed on stderr
+	
+	while getopts ":j:m:idstp" Option
+	do
+		case $Option in
+			j)
+				Jobs=$OPTARG
+				;;
+			m)
+				PlacementMode=$OPTARG
+				;;
+			i)
+				Incremental=1
+				;;
+			d)
+				Dedupe=1
+				;;
+			s)
+				Streaming=1
+				;;
+			t)
+				Timing=1
+				;;
+			p)
+				Progress=1
+				;;
+			*)
+				echo 'Use the script like this: ./1705058.sh [-j Jobs] [-m copy|hardlink|symlink|reflink|move] [-i] [-d] [-s] [-t] [-p] Working_Directory(Optional) Input_File_Name'
+				exit -1
+				;;
+		esac
 	done
 	
-	if((NumberOfExtensions!=0));
+	if [[ ! $Jobs =~ ^[1-9][0-9]*$ ]];
+	then
+		echo "Number of jobs must be a positive integer"
+		exit -1
+	fi
+	
+	case $PlacementMode in
+		copy|hardlink|symlink|reflink|move)
+			;;
+		*)
+			echo "Placement mode must be one of copy, hardlink, symlink, reflink or move"
+			exit -1
+			;;
+	esac
+	
+	if ((Incremental==1 && Dedupe==1));
+	then
+		echo "Incremental and dedupe modes can not be used together"
+		exit -1
+	fi
+	if ((Streaming==1 && (Incremental==1 || Dedupe==1)));
+	then
+		echo "Streaming mode can not be used with incremental or dedupe mode"
+		exit -1
+	fi
+	OptionCount=$((OPTIND-1))
+}
+
+#A Function Which Ends The Running Phase And Starts The One Named By $1, Only Used With -t
+#The phases are scan(find and the per file loop), classify, place and csv, an empty name just ends the running one
+StartPhase(){
+	if ((Timing==0));
 	then
-		IgnoredList=${IgnoredList%???????????} #Trimming the extra " -o -type f" from the command
+		return
 	fi
 	
-	#echo "$IgnoredList"
-	#echo "$CommandToExecute"
+	local Now=${EPOCHREALTIME/[.,]/} #Microseconds
+	if [[ -n $CurrentPhase ]];
+	then
+		PhaseTime[$CurrentPhase]=$((PhaseTime[$CurrentPhase] + Now - PhaseStart))
+	fi
+	CurrentPhase=$1
+	PhaseStart=$Now
 }
 
-#A Function That Counts The Numbers Of Files Ignored
-GetIgnoredCount(){
-	((IgnoredCount=0))
-	Files=$($1)
-	for each in $Files
+#A Function Which Reports The Phase Times On stderr As "time_<phase>, seconds" Lines
+PrintPhaseTimes(){
+	local Phase Total=0
+	for Phase in scan classify place csv
 	do
-		((IgnoredCount++))
+		printf 'time_%s, %d.%06d\n' $Phase $((PhaseTime[$Phase]/1000000)) $((PhaseTime[$Phase]%1000000)) >&2
+		Total=$((Total+PhaseTime[$Phase]))
+	done
+	printf 'time_total, %d.%06d\n' $((Total/1000000)) $((Total%1000000)) >&2
+}
+
+#A Function Which Prints A Progress Line On stderr Once $ProgressInterval Seconds Have Passed Since The Last One, Only Used With -p
+#The loops call it every 256 files, so reading the clock costs nothing next to the work itself. A non empty $1 prints the line anyway
+ReportProgress(){
+	if ((Progress==0));
+	then
+		return
+	fi
+	
+	local Now=${EPOCHREALTIME/[.,]/} #Microseconds
+	if ((Now < NextReport)) && [[ -z $1 ]];
+	then
+		return
+	fi
+	
+	local Elapsed=$((Now-LastReport > 0 ? Now-LastReport : 1))
+	local ScanRate=$(( (ScannedCount-LastScanned)*1000000/Elapsed ))
+	local FileRate=$(( (PlacedCount-LastPlaced)*1000000/Elapsed ))
+	local ByteRate=$(( (PlacedBytes-LastBytes)*1000000/Elapsed ))
+	local ETA="-"
+	if ((TotalToPlace > 0 && FileRate > 0));
+	then
+		ETA="$(( (TotalToPlace-PlacedCount)/FileRate ))s"
+	fi
+	
+	printf "scanned %d (%d/s), placed %d/%s (%d/s), %d.%d MB (%d.%d MB/s), ETA %s$ProgressEnd" \
+		$ScannedCount $ScanRate $PlacedCount "$( ((TotalToPlace > 0)) && echo $TotalToPlace || echo "?")" $FileRate \
+		$((PlacedBytes/1048576)) $((PlacedBytes%1048576*10/1048576)) $((ByteRate/1048576)) $((ByteRate%1048576*10/1048576)) "$ETA" >&2
+	
+	LastReport=$Now
+	LastScanned=$ScannedCount
+	LastPlaced=$PlacedCount
+	LastBytes=$PlacedBytes
+	NextReport=$((Now+ProgressInterval*1000000))
+}
+
+#A Function Which Prints The Machine Readable Summary Of The Run On stderr, Only Used With -p
+PrintSummary(){
+	local Now=${EPOCHREALTIME/[.,]/}
+	local Elapsed=$((Now-ProgressStart > 0 ? Now-ProgressStart : 1))
+	local IgnoredTotal=0
+	for each in "${ExtensionList[@]}"
+	do
+		IgnoredTotal=$((IgnoredTotal+IgnoredCount[$each]))
+	done
+	
+	printf 'SUMMARY scanned=%d ignored=%d placed=%d bytes=%d seconds=%d.%06d files_per_sec=%d bytes_per_sec=%d mode=%s\n' \
+		$ScannedCount $IgnoredTotal $PlacedCount $PlacedBytes $((Elapsed/1000000)) $((Elapsed%1000000)) \
+		$((PlacedCount*1000000/Elapsed)) $((PlacedBytes*1000000/Elapsed)) "$PlacementMode" >&2
+}
+
+#A Function Which Puts A List Of Files Into One Destination Folder Using $Jobs Parallel Workers
+#With -p the list is placed in chunks, so the progress line keeps moving during a large extension
+PlaceFiles(){
+	local Destination="$1"
+	shift
+	if ((Progress==0));
+	then
+		printf '%s\0' "$@" | PlaceFileStream "$Destination" $#
+		return
+	fi
+	
+	local Files=("$@") Chunk=$((256*Jobs)) Start FilePath
+	for ((Start = 0; Start < ${#Files[@]}; Start += Chunk))
+	do
+		local Part=("${Files[@]:Start:Chunk}")
+		printf '%s\0' "${Part[@]}" | PlaceFileStream "$Destination" ${#Part[@]}
+		for FilePath in "${Part[@]}"
+		do
+			PlacedBytes=$((PlacedBytes+ManifestSize[$FilePath]))
+		done
+		PlacedCount=$((PlacedCount+${#Part[@]}))
+		ReportProgress
+	done
+}
+
+#A Function Which Puts The NUL Separated Paths Read From stdin Into One Destination Folder, $2 Is The Number Of Paths
+#Only copy and reflink(when the filesystem can not share blocks) write the file contents again
+PlaceFileStream(){
+	local Destination="$1"
+	local FileNumber=$2
+	
+	#Each worker gets an even share of the files, but a cp call never gets more than 256 of them
+	local BatchSize=$(( (FileNumber + Jobs - 1) / Jobs ))
+	if((BatchSize > 256));
+	then
+		BatchSize=256
+	fi
+	
+	if((FileNumber == 0));
+	then
+		return
+	fi
+	
+	case $PlacementMode in
+		copy)
+			xargs -0 -P "$Jobs" -n "$BatchSize" cp --remove-destination -t "$Destination" --
+			;;
+		hardlink)
+			#Hard links only work inside one filesystem, cp reports the files it could not link
+			xargs -0 -P "$Jobs" -n "$BatchSize" cp --remove-destination -l -t "$Destination" --
+			;;
+		symlink)
+			#Links must hold absolute paths, relative ones would point inside output_dir
+			xargs -0 realpath -sz -- | xargs -0 -P "$Jobs" -n "$BatchSize" ln -sf -t "$Destination" --
+			;;
+		reflink)
+			xargs -0 -P "$Jobs" -n "$BatchSize" cp --remove-destination --reflink=auto -t "$Destination" --
+			;;
+		move)
+			xargs -0 -P "$Jobs" -n "$BatchSize" mv -f -t "$Destination" --
+			;;
+	esac
+}
+
+#A Function Which Puts One File Into A Destination Folder Under A Different Name
+PlaceFileAs(){
+	case $PlacementMode in
+		copy)
+			cp --remove-destination -- "$1" "$2"
+			;;
+		hardlink)
+			cp --remove-destination -l -- "$1" "$2"
+			;;
+		symlink)
+			ln -sf -- "$(realpath -s -- "$1")" "$2"
+			;;
+		reflink)
+			cp --remove-destination --reflink=auto -- "$1" "$2"
+			;;
+		move)
+			mv -f -- "$1" "$2"
+			;;
+	esac
+}
+
+#A Function Which Finds Files With The Same Contents Among The Ones Collected By CreateSubfolders
+#Only files sharing their size with another file are hashed, the hashing runs on $Jobs workers
+FindDuplicates(){
+	declare -A SizeCount #File size -> number of files with that size
+	declare -A HashOf #Path -> content hash, only for the files that were hashed
+	declare -A OwnerOf #Content key -> the first path found with those contents
+	local FilePath FileName FileStem FileExtension Record Key Suffix
+	local HashFiles=()
+	
+	for FilePath in "${FilePaths[@]}"
+	do
+		SizeCount[${ManifestSize[$FilePath]}]=$((SizeCount[${ManifestSize[$FilePath]}]+1))
+	done
+	for FilePath in "${FilePaths[@]}"
+	do
+		if ((SizeCount[${ManifestSize[$FilePath]}] > 1));
+		then
+			HashFiles+=("$FilePath")
+		fi
+	done
+	
+	if ((${#HashFiles[@]} > 0));
+	then
+		#Every worker writes its own file, parallel writers on one pipe would mix up their records
+		local HashDirectory=$(mktemp -d)
+		printf '%s\0' "${HashFiles[@]}" | xargs -0 -P "$Jobs" -n 256 sh -c 'sha256sum -z -- "$@" > "$(mktemp -p "$0")"' "$HashDirectory"
+		
+		#sha256sum -z prints "hash  path" NUL terminated, the hash always takes 64 characters
+		while IFS= read -r -d '' Record
+		do
+			HashOf[${Record:66}]=${Record:0:64}
+		done < <(cat "$HashDirectory"/*)
+		rm -rf "$HashDirectory"
+	fi
+	
+	for FilePath in "${FilePaths[@]}"
+	do
+		Key="${ManifestSize[$FilePath]}:${HashOf[$FilePath]}"
+		if [[ -n ${OwnerOf[$Key]} ]];
+		then
+			#Same contents as an earlier file, it is only listed in that file's description text
+			IsDuplicate[$FilePath]=1
+			FileExtension="${FileExtensionOf[$FilePath]}"
+			FileCount[$FileExtension]=$((FileCount[$FileExtension]-1))
+			if ((FileCount[$FileExtension]==0));
+			then
+				unset 'FileCount[$FileExtension]'
+			fi
+			FileExtensionOf[$FilePath]="${FileExtensionOf[${OwnerOf[$Key]}]}"
+			continue
+		fi
+		OwnerOf[$Key]=$FilePath
+		
+		#Different contents can still share a name, the later ones get a numbered name
+		FileName="${FilePath##*/}"
+		if [[ -n ${SeenFiles[$FileName]} ]];
+		then
+			FileStem="${FileName%.*}"
+			FileExtension=".${FileName##*.}"
+			if [[ $FileName != *'.'* || -z $FileStem ]];
+			then
+				FileStem="$FileName"
+				FileExtension=""
+			fi
+			Suffix=2
+			while [[ -n ${SeenFiles[${FileStem}_$Suffix$FileExtension]} ]];
+			do
+				Suffix=$((Suffix+1))
+			done
+			FileName="${FileStem}_$Suffix$FileExtension"
+			PlacedName[$FilePath]=$FileName
+		fi
+		SeenFiles[$FileName]=$FilePath
 	done
-	echo "ignored, $IgnoredCount" >> $2
+}
+
+#A Function Which Loads The Manifest Left By An Earlier Run
+#Every record is path, size, modification time and destination folder, each field NUL terminated
+LoadManifest(){
+	local FilePath FileSize FileTime Destination
+	while IFS= read -r -d '' FilePath && IFS= read -r -d '' FileSize && IFS= read -r -d '' FileTime && IFS= read -r -d '' Destination
+	do
+		ManifestPaths+=("$FilePath")
+		ManifestSize[$FilePath]=$FileSize
+		ManifestTime[$FilePath]=$FileTime
+		ManifestDestination[$FilePath]=$Destination
+	done < "$1"
+}
+
+#A Function Which Writes The Manifest For The Next Incremental Run
+WriteManifest(){
+	local FilePath
+	for FilePath in "${ManifestPaths[@]}"
+	do
+		printf '%s\0%s\0%s\0%s\0' "$FilePath" "${ManifestSize[$FilePath]}" "${ManifestTime[$FilePath]}" "${ManifestDestination[$FilePath]}"
+	done > "$1.tmp"
+	mv -f "$1.tmp" "$1" #A run killed halfway keeps the old manifest
 }
 
 #A function Which Creates Subfolder For Each File Types, the distributes the files
 CreateSubfolders(){
 	declare -A FileCount #A Hashmap to store the count of different file types
-	Extension=$($1 | sed 's/.*\.//' | sort -u) #Gets the unique extensions of files by subtracting everything before a ".", leaving only the extension
-	Extension=$(echo "$Extension" | sed 's/.*\/.*/others/' | sort -u) #If there is any file without extension, it will be put under "others" folder
-	#echo "$Extension"
+	declare -A FileExtensionOf #Path of every file to be placed -> its extension
+	declare -A IsNewFile #Paths that have to be added to the description files
+	declare -A SeenFiles #File name -> the path that took it, only the first file found with a name is copied
+	declare -A IsDuplicate #Paths whose contents are already placed from another path, in dedupe mode
+	declare -A PlacedName #Path -> name in the output folder, when it can not keep its own name
+	local FilePaths=() #Paths to be placed, in the order find reported them
+	local FilePath FileName FileExtension FileSize FileTime IgnoredType
 	
-	AllDirectories=$($1)
-	AllUniqueFiles=$($1 | sed 's/.*\///' | sort -u) #Subtracts everything before the last "/", leaving only the filename with extension
+	StartPhase scan
+	local ManifestPaths=()
+	declare -A ManifestSize ManifestTime ManifestDestination
+	local ManifestFile="$1/.manifest"
+	if ((Incremental==1)) && [ -f "$ManifestFile" ];
+	then
+		LoadManifest "$ManifestFile"
+	else
+		Incremental=0 #Nothing to build on, so everything is organized from scratch
+	fi
 	
-	for each in $Extension
+	#Files placed by earlier runs stay in the output, so they keep their names and are counted again
+	for FilePath in "${ManifestPaths[@]}"
 	do
-		mkdir -p "$2/$each" #Make Sub Folders
-		touch "$2/$each/desc_$each.txt" #Make File Description Text
-		>"$2/$each/desc_$each.txt" 
-		((Counter=0))
-		FileCount[$each]="$Counter"
+		SeenFiles[${FilePath##*/}]=$FilePath
+		FileExtension="${ManifestDestination[$FilePath]}"
+		FileCount[$FileExtension]=$((FileCount[$FileExtension]+1))
 	done
 	
-	
-	local IFS=$'\n' #Setting local ISF to newline so that files with space in their names can be detected
-	for file in $AllUniqueFiles #Looping through all the unique files
+	#One traversal classifies every file, there is no need to search the paths again later
+	while IFS= read -r -d '' IgnoredType && IFS= read -r -d '' FileSize && IFS= read -r -d '' FileTime && IFS= read -r -d '' FilePath
 	do
-		FileDirectory=""
-		FileExtension=""
-		Destination="output_dir"
-		#echo "$file"
+		if (( (++ScannedCount & 255) == 0 ));
+		then
+			ReportProgress
+		fi
+		if [[ -n $IgnoredType ]];
+		then
+			IgnoredCount[$IgnoredType]=$((IgnoredCount[$IgnoredType]+1))
+			continue
+		fi
+		FileName="${FilePath##*/}" #Subtracts everything before the last "/", leaving only the filename with extension
+		if [[ -n ${ManifestDestination[$FilePath]} ]];
+		then
+			if [[ ${ManifestSize[$FilePath]} == "$FileSize" && ${ManifestTime[$FilePath]} == "$FileTime" ]];
+			then
+				continue #Unchanged since the last run
+			fi
+			FileExtension="${ManifestDestination[$FilePath]}" #Changed, placed again over the old output
+		else
+			if ((Dedupe==0));
+			then
+				if [[ -n ${SeenFiles[$FileName]} ]];
+				then
+					continue
+				fi
+				SeenFiles[$FileName]=$FilePath
+			fi
+			
+			FileExtension="${FileName##*.}" #Subtracts everything before a ".", leaving only the extension
+			if [[ $FileName != *'.'* || -z $FileExtension ]];
+			then
+				FileExtension="others" #If file does not have extension
+			fi
+			
+			IsNewFile[$FilePath]=1
+			ManifestPaths+=("$FilePath")
+			ManifestDestination[$FilePath]=$FileExtension
+			FileCount[$FileExtension]=$((FileCount[$FileExtension]+1))
+		fi
 		
-		local IFS=$'\n' #Setting local ISF to newline so that directories with space in their names can be detected
-		for Directory in $AllDirectories #Loop to obtain the directory of the file
+		ManifestSize[$FilePath]=$FileSize
+		ManifestTime[$FilePath]=$FileTime
+		FilePaths+=("$FilePath")
+		FileExtensionOf[$FilePath]="$FileExtension"
+	done < <(find "${FindArguments[@]}")
+	
+	StartPhase classify
+	WriteRunSummary "$2"
+	if ((Dedupe==1));
+	then
+		FindDuplicates
+	fi
+	
+	declare -A FilesOf #Extension -> indices into FilePaths, in traversal order
+	local Index
+	for Index in "${!FilePaths[@]}"
+	do
+		FilesOf[${FileExtensionOf[${FilePaths[$Index]}]}]+=" $Index"
+	done
+	
+	StartPhase place
+	TotalToPlace=$(( ${#FilePaths[@]} - ${#IsDuplicate[@]} ))
+	for each in "${!FileCount[@]}"
+	do
+		local ExtensionFiles=() NewFiles=()
+		for Index in ${FilesOf[$each]}
 		do
-			#echo "$Directory"		
-			if [[ $Directory = *"$file"* ]];
+			FilePath="${FilePaths[$Index]}"
+			if [[ -n ${IsNewFile[$FilePath]} ]];
+			then
+				NewFiles+=("$FilePath")
+			fi
+			if [[ -z ${IsDuplicate[$FilePath]} && -z ${PlacedName[$FilePath]} ]];
 			then
-				FileDirectory="$Directory"
-				break
+				ExtensionFiles+=("$FilePath")
 			fi
 		done
-		unset IFS
 		
-		if [[ $file = *'.'* ]];
+		mkdir -p "$1/$each" #Make Sub Folders
+		if ((Incremental==0));
+		then
+			printf '%s\n' "${NewFiles[@]}" > "$1/$each/desc_$each.txt" #File Description Text is written once from the collected list
+		elif ((${#NewFiles[@]} > 0));
+		then
+			printf '%s\n' "${NewFiles[@]}" >> "$1/$each/desc_$each.txt" #Earlier runs already listed the rest
+		fi
+		PlaceFiles "$1/$each" "${ExtensionFiles[@]}" #Copy Files To Destination
+	done
+	
+	for FilePath in "${!PlacedName[@]}" #Renamed files are placed one by one
+	do
+		PlaceFileAs "$FilePath" "$1/${FileExtensionOf[$FilePath]}/${PlacedName[$FilePath]}"
+		PlacedCount=$((PlacedCount+1))
+		PlacedBytes=$((PlacedBytes+ManifestSize[$FilePath]))
+	done
+	
+	StartPhase csv
+	for each in "${!FileCount[@]}" #Write the file counts in the csv
+	do
+		echo "$each, ${FileCount[$each]}" >> $2
+	done
+	
+	if ((Dedupe==0));
+	then
+		WriteManifest "$ManifestFile"
+	else
+		rm -f "$ManifestFile" #Dedupe runs do not place one file per path, so an incremental run has to start over
+	fi
+	StartPhase ""
+}
+
+#A Function Which Organizes The Files While find Is Still Reporting Them
+#Memory only grows with the number of extensions, pending files wait in one NUL separated batch file per extension
+#A name is taken once its output file exists, so files organized by earlier runs keep their place and their description lines
+#With -t the scan phase also holds the placing of the batches flushed while find is running
+StreamSubfolders(){
+	StartPhase scan
+	declare -A PendingCount #Extension -> number of files waiting in its batch file
+	declare -A PendingBytes #Extension -> total size of the files waiting in its batch file
+	declare -A FileCount #Extension -> number of files in its output folder
+	local BatchDirectory=$(mktemp -d)
+	local FileSize FileTime FilePath FileName FileExtension Destination DescFile IgnoredType
+	
+	#Files organized by earlier runs stay in the output, so they are counted again
+	#The files are counted instead of the description lines, a name can hold a newline
+	for DescFile in "$1"/*/desc_*.txt
+	do
+		FileExtension="${DescFile%/*}"
+		FileExtension="${FileExtension##*/}"
+		if [[ -f $DescFile && $DescFile == "$1/$FileExtension/desc_$FileExtension.txt" ]];
+		then
+			FileCount[$FileExtension]=$(find "$1/$FileExtension" -mindepth 1 -maxdepth 1 ! -name "desc_$FileExtension.txt" -printf '.' | wc -c)
+		fi
+	done
+	
+	#Flushes the batch file of one extension
+	FlushBatch(){
+		if ((PendingCount[$2]==0));
+		then
+			return
+		fi
+		PlaceFileStream "$1/$2" "${PendingCount[$2]}" < "$BatchDirectory/$2"
+		>"$BatchDirectory/$2"
+		PlacedCount=$((PlacedCount+PendingCount[$2]))
+		PlacedBytes=$((PlacedBytes+PendingBytes[$2]))
+		PendingCount[$2]=0
+		PendingBytes[$2]=0
+		ReportProgress
+	}
+	
+	while IFS= read -r -d '' IgnoredType && IFS= read -r -d '' FileSize && IFS= read -r -d '' FileTime && IFS= read -r -d '' FilePath
+	do
+		if (( (++ScannedCount & 255) == 0 ));
+		then
+			ReportProgress
+		fi
+		if [[ -n $IgnoredType ]];
+		then
+			IgnoredCount[$IgnoredType]=$((IgnoredCount[$IgnoredType]+1))
+			continue
+		fi
+		FileName="${FilePath##*/}" #Subtracts everything before the last "/", leaving only the filename with extension
+		FileExtension="${FileName##*.}" #Subtracts everything before a ".", leaving only the extension
+		if [[ $FileName != *'.'* || -z $FileExtension ]];
 		then
-			FileExtension="$(echo "$file" | sed 's/.*\.//')" #If file has extension
-		else
 			FileExtension="others" #If file does not have extension
 		fi
 		
-		Destination="$Destination/$FileExtension"
-		cp "$FileDirectory" $Destination #Copy File To Destination
-		echo "$FileDirectory" >> "$Destination/desc_$FileExtension.txt" #Add file directory to description text file
+		Destination="$1/$FileExtension/$FileName"
+		if [[ -z ${PendingCount[$FileExtension]} ]];
+		then
+			mkdir -p "$1/$FileExtension" #Make Sub Folders
+			PendingCount[$FileExtension]=0
+		fi
+		if [[ -e $Destination || -L $Destination ]];
+		then
+			continue #Only the first file found with a name is placed
+		fi
+		>"$Destination" #Reserves the name until the batch is flushed
 		FileCount[$FileExtension]=$((FileCount[$FileExtension]+1))
+		
+		printf '%s\0' "$FilePath" >> "$BatchDirectory/$FileExtension"
+		printf '%s\n' "$FilePath" >> "$1/$FileExtension/desc_$FileExtension.txt" #Add file directory to description text file
+		PendingCount[$FileExtension]=$((PendingCount[$FileExtension]+1))
+		PendingBytes[$FileExtension]=$((PendingBytes[$FileExtension]+FileSize))
+		if ((PendingCount[$FileExtension] >= 256*Jobs));
+		then
+			FlushBatch "$1" "$FileExtension"
+		fi
+	done < <(find "${FindArguments[@]}")
+	
+	StartPhase place
+	for FileExtension in "${!PendingCount[@]}"
+	do
+		FlushBatch "$1" "$FileExtension"
 	done
-	unset IFS
+	rm -rf "$BatchDirectory"
+	rm -f "$1/.manifest" #Not kept up to date here, so an incremental run has to start over
 	
-	for each in ${!FileCount[@]} #Write the file counts in the csv
+	StartPhase csv
+	WriteRunSummary "$2"
+	for each in "${!FileCount[@]}" #Write the file counts in the csv
 	do
-		echo "$each, ${FileCount[$each]}" >> $3
+		echo "$each, ${FileCount[$each]}" >> $2
 	done
+	StartPhase ""
 }
 
 #A Function Which Creates And Writes To The Output CSV File
@@ -183,19 +709,51 @@ CreateOutputCSV(){
 main(){
 	#declare -A FileCount
 	CSVName="output.csv"
-	GetInput $*
+	MetaCSVName="output_meta.csv" #Details of the run that are not file counts
+	GetOptions "$@"
+	shift $OptionCount
+	GetInput "$@"
 	GetIgnorableTypes $InputFile
-	CreateFileCommand $WorkingDirectory ${Types[@]}
+	CreateFileCommand "$WorkingDirectory" "${Types[@]}"
 	CreateOutputCSV $CSVName
+	declare -A IgnoredCount #Ignored type -> number of files of that type, filled by the traversal
+	declare -A PhaseTime #Phase -> microseconds spent in it
+	CurrentPhase=""
+	
+	ScannedCount=0 #Files reported by find, ignored ones included
+	PlacedCount=0 #Files put into the output in this run
+	PlacedBytes=0
+	TotalToPlace=0 #Known once the scan is over, stays 0 in streaming mode
+	ProgressInterval=1 #Seconds between two progress lines
+	ProgressStart=${EPOCHREALTIME/[.,]/}
+	LastReport=$ProgressStart LastScanned=0 LastPlaced=0 LastBytes=0
+	NextReport=$((ProgressStart+ProgressInterval*1000000))
+	ProgressEnd="\n"
+	if [ -t 2 ];
+	then
+		ProgressEnd="\r" #A terminal gets one line that is rewritten
+	fi
 	
-	if [[ "$IgnoredList" = "find $WorkingDirectory -type f" ]]
+	if ((Streaming==1));
 	then
-		echo "ignored, 0" >> $CSVName
+		StreamSubfolders "$OutputDirectory" "$CSVName"
 	else
-		GetIgnoredCount "$IgnoredList" "$CSVName"
+		CreateSubfolders "$OutputDirectory" "$CSVName"
 	fi
 	
-	CreateSubfolders "$CommandToExecute" "$OutputDirectory" "$CSVName"
+	if ((Timing==1));
+	then
+		PrintPhaseTimes
+	fi
+	if ((Progress==1));
+	then
+		ReportProgress final
+		if [ -t 2 ];
+		then
+			echo >&2
+		fi
+		PrintSummary
+	fi
 }
 
-main $*
+main "$@"
@@ -0,0 +1,152 @@
+#!/bin/bash
+
+#Benchmark driver for 1705058.sh
+#Generates synthetic trees, runs the organizer on them with -t and prints the time of each phase
+#Use it like this: ./benchmark.sh [-n "FileCounts"] [-d Depth] [-w Width] [-e "Extensions"] [-i "IgnoredTypes"] [-b Bytes] [-r Repetitions] [-o "OrganizerOptions"]
+
+#A Function For Reading The Benchmark Options
+GetOptions(){
+	FileCounts="1000 10000 100000" #One tree is generated for each count
+	Depth=3 #Levels of directories below the working directory
+	Width=4 #Directories inside every directory
+	Extensions="txt cpp c py pdf sh jpg NONE" #Extension mix, NONE makes files without an extension
+	IgnoredTypes="pdf sh" #Written to the organizer's input file
+	FileBytes=0 #Size of every generated file
+	Repetitions=3 #Runs per tree, the fastest one is reported
+	OrganizerOptions="" #Extra options given to the organizer, like "-j 4 -m hardlink"
+
+	while getopts ":n:d:w:e:i:b:r:o:" Option
+	do
+		case $Option in
+			n)
+				FileCounts=$OPTARG
+				;;
+			d)
+				Depth=$OPTARG
+				;;
+			w)
+				Width=$OPTARG
+				;;
+			e)
+				Extensions=$OPTARG
+				;;
+			i)
+				IgnoredTypes=$OPTARG
+				;;
+			b)
+				FileBytes=$OPTARG
+				;;
+			r)
+				Repetitions=$OPTARG
+				;;
+			o)
+				OrganizerOptions=$OPTARG
+				;;
+			*)
+				echo 'Use the script like this: ./benchmark.sh [-n "FileCounts"] [-d Depth] [-w Width] [-e "Extensions"] [-i "IgnoredTypes"] [-b Bytes] [-r Repetitions] [-o "OrganizerOptions"]'
+				exit -1
+				;;
+		esac
+	done
+
+	for each in $FileCounts $Depth $Width $FileBytes $Repetitions
+	do
+		if [[ ! $each =~ ^[0-9]+$ ]];
+		then
+			echo "File counts, depth, width, bytes and repetitions must be numbers"
+			exit -1
+		fi
+	done
+
+	if [[ " $OrganizerOptions " == *" -m move "* || " $OrganizerOptions " == *" -mmove "* ]];
+	then
+		echo "Move mode empties the tree, so it can not be run more than once on it"
+		exit -1
+	fi
+}
+
+#A Function Which Generates A Tree Of $2 Files Inside $1
+#Files are spread over every directory, every seventh name has a space and every eleventh file repeats an earlier name in another directory
+GenerateTree(){
+	mkdir -p "$1"
+
+	#awk prints the directories first and then the files, each path NUL terminated(%c with 0, mawk cuts strings at "\0") and prefixed with D or F
+	awk -v Root="$1" -v Files="$2" -v Depth="$Depth" -v Width="$Width" -v Extensions="$Extensions" '
+	BEGIN {
+		ExtensionCount = split(Extensions, Extension, " ")
+		DirectoryCount = 1
+		Directory[1] = Root
+		Level[1] = 0
+		for (Index = 1; Index <= DirectoryCount; Index++) {
+			if (Level[Index] == Depth)
+				continue
+			for (Child = 1; Child <= Width; Child++) {
+				DirectoryCount++
+				Directory[DirectoryCount] = Directory[Index] "/dir " Level[Index] + 1 "_" Child
+				Level[DirectoryCount] = Level[Index] + 1
+				printf "D%s%c", Directory[DirectoryCount], 0
+			}
+		}
+		for (File = 0; File < Files; File++) {
+			Base = (File % 11 == 10) ? File - 10 : File
+			Name = "file_" Base
+			if (Base % 7 == 3)
+				Name = Name " copy"
+			Type = Extension[Base % ExtensionCount + 1]
+			if (Type != "NONE")
+				Name = Name "." Type
+			printf "F%s/%s%c", Directory[File % DirectoryCount + 1], Name, 0
+		}
+	}' > "$1.list"
+
+	grep -z '^D' "$1.list" | sed -z 's/^D//' | xargs -0 -r mkdir -p --
+	if ((FileBytes == 0));
+	then
+		grep -z '^F' "$1.list" | sed -z 's/^F//' | xargs -0 -r touch --
+	else
+		grep -z '^F' "$1.list" | sed -z 's/^F//' | xargs -0 -r truncate -s "$FileBytes" --
+	fi
+	rm -f "$1.list"
+}
+
+#A Function Which Runs The Organizer On One Tree And Keeps The Fastest Time Of Every Phase
+#$1 is the scratch directory holding the tree "work" and the input file
+RunOrganizer(){
+	declare -A Best
+	local Run Phase Seconds
+
+	for ((Run = 1; Run <= Repetitions; Run++))
+	do
+		rm -rf "$1/output_dir" "$1/output.csv" "$1/output_meta.csv"
+		while IFS=', ' read -r Phase Seconds
+		do
+			Phase="${Phase#time_}"
+			if [[ -z ${Best[$Phase]} ]] || awk -v New="$Seconds" -v Old="${Best[$Phase]}" 'BEGIN { exit !(New < Old) }';
+			then
+				Best[$Phase]=$Seconds
+			fi
+		done < <(cd "$1" && bash "$Organizer" -t $OrganizerOptions work input.txt 2>&1 >/dev/null | grep '^time_')
+	done
+
+	printf '%10s %10s %10s %10s %10s %10s\n' "$2" "${Best[scan]}" "${Best[classify]}" "${Best[place]}" "${Best[csv]}" "${Best[total]}"
+}
+
+main(){
+	GetOptions "$@"
+	Organizer="$(cd "$(dirname "$0")" && pwd)/1705058.sh"
+	ScratchDirectory=$(mktemp -d)
+	trap 'rm -rf "$ScratchDirectory"' EXIT
+
+	echo "depth $Depth, width $Width, extensions \"$Extensions\", ignored \"$IgnoredTypes\", $FileBytes bytes per file, best of $Repetitions, options \"$OrganizerOptions\""
+	printf '%10s %10s %10s %10s %10s %10s\n' files scan classify place csv total
+
+	for Count in $FileCounts
+	do
+		rm -rf "$ScratchDirectory"/*
+		GenerateTree "$ScratchDirectory/work" "$Count"
+		printf '%s\n' $IgnoredTypes > "$ScratchDirectory/input.txt"
+		RunOrganizer "$ScratchDirectory" "$Count"
+	done
+}
+
+main "$@"
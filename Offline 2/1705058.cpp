@@ -6,15 +6,44 @@
 #include<semaphore.h>
 #include<unistd.h>
 #include<chrono>
+#include<cmath>
+#include<iomanip>
+#include<sstream>
+#include<sys/mman.h>
+#include<sys/wait.h>
+#include<signal.h>
+#include<atomic>
+#include<cstdio>
+#include<vector>
+#include<algorithm>
+#include<cerrno>
 
 #define TOTAL_ARRIVALS 10
 #define SIMULATION_TIME_MINUTES 60.0
 #define PRINT_TO_CONSOLE true
 #define PRINT_TO_FILE true
+#define ANALYTICAL_ESTIMATE true // Print the queueing-network estimate before simulating
+#define RUN_SIMULATION true // Run the threaded simulation, set false to only get the estimate
+#define BOARDING_PASS_LOSS_PROBABILITY (1.0 / 3.0) // Matches the % 3 draw in Boarding
+#define REPLICATIONS 1 // More than 1 forks one worker process per replication, each with its own seed
+#define CHECKPOINT_FILE "checkpoint.txt"
+#define CHECKPOINT_INTERVAL 10 // Seconds between checkpoints, 0 to checkpoint only on SIGUSR1
+#define RESUME_FROM_CHECKPOINT false // Continue from CHECKPOINT_FILE instead of generating new arrivals
+#define BOARDING_MODE SINGLE_BOARDING // SINGLE_BOARDING admits one passenger at a time, BATCH_BOARDING admits groups
+#define BATCH_POLICY WINDOW_BATCH // WINDOW_BATCH, ZONE_BATCH or VIP_BATCH, how a batch is picked from the waiting passengers
+#define BATCH_SIZE 4 // Largest batch the gate admits at once
+#define BATCH_TIMEOUT 2 // Seconds the gate waits for a batch to fill after the first passenger arrives
+#define BATCH_SERVICE_TIME 0 // Seconds to board one batch, 0 uses Y
+#define BOARDING_ZONES 3
 using namespace std;
 using namespace chrono;
 
 /*-------------------------Passenger Structure-------------------------*/
+enum BoardingMode {SINGLE_BOARDING, BATCH_BOARDING};
+enum BatchPolicy {WINDOW_BATCH, ZONE_BATCH, VIP_BATCH};
+enum Station {KIOSK_STATION, SECURITY_STATION, VIP_FORWARD_STATION, VIP_BACKWARD_STATION, BOARDING_STATION, SPECIAL_KIOSK_STATION, TOTAL_STATIONS};
+const string StationNames[TOTAL_STATIONS] = {"Kiosk", "Security Belt", "VIP Forward", "VIP Backward", "Boarding", "Special Kiosk"};
+
 struct Passenger
 {
     int PassengerID = -1;
@@ -25,6 +54,11 @@ struct Passenger
     int HasBoardingPass = -1;
     int BoardingComplete = 0;
     string Identity;
+    int Arrived = 0; // 1 once the passenger is inside the airport
+    int Stage = KIOSK_STATION; // Next station to visit, TOTAL_STATIONS once boarded
+    int BoardingAttempts = 0; // Finished visits to boarding, picks the next random draw
+    double BatchAdmitted = 0; // Time the batch of this passenger started boarding
+    double BatchShare = 0; // This passenger's share of the batch service time
 
     void CopyPassenger(Passenger pass){
         PassengerID = pass.PassengerID;
@@ -34,6 +68,9 @@ struct Passenger
         SecurityBelt = pass.SecurityBelt;
         HasBoardingPass = pass.HasBoardingPass;
         Identity = pass.Identity;
+        Arrived = pass.Arrived;
+        Stage = pass.Stage;
+        BoardingAttempts = pass.BoardingAttempts;
     }
 };
 
@@ -42,12 +79,16 @@ struct Passenger
 // Program
 int* Kiosk;
 Passenger AllPassenger[TOTAL_ARRIVALS];
+Passenger* ActivePassenger[TOTAL_ARRIVALS]; // The copy each passenger thread works on, null until it arrives
 pthread_t AllThreads[TOTAL_ARRIVALS];
 int M, N, P, W, X, Y, Z; // Given values from file
 pthread_mutex_t print_mutex;    // Self explanatory
 time_point<steady_clock> StartTime;
 int FirstPassengerTime = 0;
 ofstream OutputFile;
+string OutputFileName = "output.txt";
+bool ConsoleOutput = PRINT_TO_CONSOLE; // Replication workers stay quiet
+unsigned int Seed = time(0); // Seeds the arrival generator and every passenger's random decisions
 
 // Kiosk
 pthread_mutex_t kiosk_check_mutex;  // Used when checking available kiosk
@@ -68,9 +109,74 @@ pthread_mutex_t channel_mutex; // Mutex for locking the channel
 // Boarding
 pthread_mutex_t boarding_check_mutex; // Mutex for locking the boarding area which has capacity of 1
 
+// Batched Boarding
+vector<Passenger*> GateQueue; // Passengers with a boarding pass waiting for their batch, in arrival order
+bool GateClosed = false; // Set once every passenger is done so the gate thread can leave
+int NextZone = 0; // Zone the gate calls next under ZONE_BATCH
+pthread_mutex_t gate_mutex; // Mutex for GateQueue, GateClosed and NextZone
+pthread_cond_t gate_cond; // Signalled when a passenger joins the queue or the gate closes
+sem_t boarded_sem[TOTAL_ARRIVALS]; // Posted when the batch of a passenger has boarded
+
 // Special Kiosk
 pthread_mutex_t special_kiosk_mutex; // Mutex for locking the special kiosk which has capacity of 1
 
+// Statistics
+struct StationStatistics
+{
+    int Visits = 0;
+    double TotalWait = 0; // Time spent waiting before service started
+    double TotalBusy = 0; // Time a server of this station was occupied
+};
+StationStatistics Statistics[TOTAL_STATIONS];
+struct GateStatistics
+{
+    int Handoffs = 0; // Times the gate was handed to a passenger or a batch
+    int Passengers = 0; // Passengers that went through the gate, including lost passes in single mode
+    double Busy = 0; // Time the gate was occupied
+    double Formation = 0; // Time spent waiting for batches to fill
+};
+GateStatistics Gate;
+int PassengersBoarded = 0;
+double TotalTimeInSystem = 0;
+double LastBoardingTime = 0;
+pthread_mutex_t statistics_mutex; // Mutex for updating the statistics and passenger stages
+
+// Checkpoint
+string CheckpointFileName = CHECKPOINT_FILE;
+bool Resumed = false;
+double ResumeClock = 0; // Simulation time stored in the checkpoint we resumed from
+atomic<bool> SimulationFinished(false);
+
+// Analytical Estimate
+struct StationEstimate
+{
+    double Servers = 1; // Parallel servers the utilization is measured against
+    double ArrivalRate = 0; // Visits per time unit
+    double Utilization = 0;
+    double Wait = 0; // Expected waiting time before service starts
+};
+struct NetworkEstimate
+{
+    StationEstimate Stations[TOTAL_STATIONS];
+    double Throughput = 0; // Passengers boarded per time unit
+    double TimeInSystem = 0; // Expected time from arrival to boarding
+    bool Stable = true;
+    double ComputeMicroseconds = 0;
+};
+NetworkEstimate Estimate;
+
+// Replications
+struct ReplicationResult
+{
+    unsigned int Seed = 0;
+    int Completed = 0;
+    int PassengersBoarded = 0;
+    double Throughput = 0;
+    double TimeInSystem = 0;
+    double Utilization[TOTAL_STATIONS] = {0};
+    double Wait[TOTAL_STATIONS] = {0};
+};
+
 /*-------------------------Utilities-------------------------*/
 
 // Prioritizing empty kiosk, this function returns an empty kiosk
@@ -83,13 +189,104 @@ int GetEmptyKiosk(){
     return -1;
 }
 
+// A function that returns the current simulation time with sub-second precision
+double CurrentTime(){
+    duration<double> Diff = steady_clock::now() - StartTime;
+    return Diff.count() + FirstPassengerTime;
+}
+
+// A function that returns how many passengers a station can serve at once
+double StationServers(int station){
+    if(station == KIOSK_STATION){
+        return M;
+    }
+    if(station == SECURITY_STATION){
+        return N * P;
+    }
+    return 1;
+}
+
+// A function that returns a random number for one decision of a passenger
+// Draws depend only on the seed, the passenger and the decision, never on thread timing, so a resumed run decides the same
+unsigned int PassengerRandom(Passenger* passenger, int Decision){
+    unsigned long long Value = ((unsigned long long) Seed << 32) ^ ((unsigned long long) passenger->PassengerID << 16) ^ Decision;
+    // SplitMix64 finalizer
+    Value += 0x9e3779b97f4a7c15ULL;
+    Value = (Value ^ (Value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    Value = (Value ^ (Value >> 27)) * 0x94d049bb133111ebULL;
+    Value ^= Value >> 31;
+    return (unsigned int) (Value >> 1);
+}
+
+// A function that returns the station a passenger goes to after finishing one
+int NextStage(Passenger* passenger, Station station){
+    switch(station){
+        case KIOSK_STATION:
+            // Non VIP need Security Check, VIP Has special channel
+            return (passenger->VIP == 0) ? SECURITY_STATION : VIP_FORWARD_STATION;
+        case BOARDING_STATION:
+            // Only possible way the boarding is not done is when the pass is lost, so, return to special kiosk
+            return (passenger->BoardingComplete == 1) ? TOTAL_STATIONS : VIP_BACKWARD_STATION;
+        case VIP_BACKWARD_STATION:
+            return SPECIAL_KIOSK_STATION;
+        case SPECIAL_KIOSK_STATION:
+            // Then return via VIP Channel
+            return VIP_FORWARD_STATION;
+        default:
+            return BOARDING_STATION;
+    }
+}
+
+// A function that records one visit of a passenger to a station and moves the passenger to the next one
+// Both happen under one lock so a checkpoint never sees a visit without the stage change or the other way around
+void RecordVisit(Passenger* passenger, Station station, double Wait, double Busy){
+    pthread_mutex_lock(&statistics_mutex);
+    Statistics[station].Visits++;
+    Statistics[station].TotalWait += Wait;
+    Statistics[station].TotalBusy += Busy;
+
+    if(station == BOARDING_STATION){
+        passenger->BoardingAttempts++;
+        if(passenger->BoardingComplete == 1){
+            // Time in system is measured from the scheduled arrival
+            PassengersBoarded++;
+            LastBoardingTime = CurrentTime();
+            TotalTimeInSystem += LastBoardingTime - passenger->ArrivalTime;
+        }
+    }
+    passenger->Stage = NextStage(passenger, station);
+    pthread_mutex_unlock(&statistics_mutex);
+}
+
+// A function that records one handoff of the boarding gate
+void RecordGateHandoff(int Passengers, double Busy, double Formation){
+    pthread_mutex_lock(&statistics_mutex);
+    Gate.Handoffs++;
+    Gate.Passengers += Passengers;
+    Gate.Busy += Busy;
+    Gate.Formation += Formation;
+    pthread_mutex_unlock(&statistics_mutex);
+}
+
+// A function that sleeps until the simulation clock reaches Time
+void SleepUntil(double Time){
+    double Delay = Time - CurrentTime();
+    if(Delay <= 0){
+        return;
+    }
+    timespec Duration;
+    Duration.tv_sec = (time_t) Delay;
+    Duration.tv_nsec = (long) ((Delay - Duration.tv_sec) * 1e9);
+    nanosleep(&Duration, NULL);
+}
+
 // A function to write output to console
 void PrintWithTime(string ToPrint){
     pthread_mutex_lock(&print_mutex);
 
     duration<double> Diff = steady_clock::now() - StartTime;
     int Time = (int) Diff.count() + FirstPassengerTime;
-    if(PRINT_TO_CONSOLE){
+    if(ConsoleOutput){
         cout << ToPrint << " at time " << Time << endl;
     }
     if(PRINT_TO_FILE){
@@ -100,6 +297,8 @@ void PrintWithTime(string ToPrint){
 
 // A function which simulates the self check in kiosk
 void SelfCheckUp(Passenger* passenger){
+    double QueueEnter = CurrentTime();
+
     // Find an empty kiosk
     pthread_mutex_lock(&kiosk_check_mutex);
     sem_wait(&kiosk_sem);
@@ -111,10 +310,12 @@ void SelfCheckUp(Passenger* passenger){
     // Lock the kiosk and do self checkup
     pthread_mutex_lock(&kiosk_mutex[passenger->KioskNumber]);
     PrintWithTime("Passenger " + passenger->Identity + " has started self-check in kiosk " + to_string((passenger->KioskNumber+1)));
+    double ServiceStart = CurrentTime();
 
     sleep(W);
     
     PrintWithTime("Passenger " + passenger->Identity + " has finished self-check");
+    RecordVisit(passenger, KIOSK_STATION, ServiceStart - QueueEnter, CurrentTime() - ServiceStart);
 
     Kiosk[passenger->KioskNumber] = 1;
     pthread_mutex_unlock(&kiosk_mutex[passenger->KioskNumber]);
@@ -124,17 +325,20 @@ void SelfCheckUp(Passenger* passenger){
 // A function which simulates the Security Check for non VIP
 void SecurityBeltnonVIP(Passenger* passenger){
     // Join a security belt
-    int SecurityBelt = rand()%N;
+    int SecurityBelt = PassengerRandom(passenger, 0) % N;
     passenger->SecurityBelt = SecurityBelt;
 
     PrintWithTime("Passenger " + passenger->Identity + " has started waiting for security check in belt " + to_string(passenger->SecurityBelt+1));
+    double QueueEnter = CurrentTime();
 
     // Do checkup, wait if the belt is not empty
     sem_wait(&security_belt_sem[passenger->SecurityBelt]);
 
     PrintWithTime("Passenger " + passenger->Identity + " has started the security check in belt " + to_string(passenger->SecurityBelt+1));
+    double ServiceStart = CurrentTime();
     sleep(X);
     PrintWithTime("Passenger " + passenger->Identity + " has crossed security check");
+    RecordVisit(passenger, SECURITY_STATION, ServiceStart - QueueEnter, CurrentTime() - ServiceStart);
 
     sem_post(&security_belt_sem[passenger->SecurityBelt]);
 }
@@ -142,6 +346,7 @@ void SecurityBeltnonVIP(Passenger* passenger){
 // A function which simulates the VIP Channel going forward
 void LeftToRight(Passenger* passenger){
     PrintWithTime("Passenger " + passenger->Identity + " has arrived in front of VIP Channel");
+    double QueueEnter = CurrentTime();
 
     // Left to right count increase
     pthread_mutex_lock(&ltr_count_mutex);
@@ -155,8 +360,10 @@ void LeftToRight(Passenger* passenger){
 
     // Pass the VIP Channel
     PrintWithTime("Passenger " + passenger->Identity + " has started passing through VIP Channel");
+    double ServiceStart = CurrentTime();
     sleep(Z);
     PrintWithTime("Passenger " + passenger->Identity + " has crossed VIP Channel");
+    RecordVisit(passenger, VIP_FORWARD_STATION, ServiceStart - QueueEnter, CurrentTime() - ServiceStart);
 
     // Left to right count decrease
     pthread_mutex_lock(&ltr_count_mutex);
@@ -173,6 +380,7 @@ void LeftToRight(Passenger* passenger){
 // A function which simulates the VIP Channel going backward
 void RightToLeft(Passenger* passenger){
     PrintWithTime("Passenger " + passenger->Identity + " has arrived in front of VIP Channel to go backward");
+    double QueueEnter = CurrentTime();
 
     pthread_mutex_lock(&vip_way_mutex); // As long as there are passenger going from left to right, this will never be unlocked to begin with, so, passenger will wait
     pthread_mutex_unlock(&vip_way_mutex); // It is unlocked immedietly so that other passenger waiting may also get on the channel
@@ -188,8 +396,10 @@ void RightToLeft(Passenger* passenger){
 
     // Pass the channel
     PrintWithTime("Passenger " + passenger->Identity + " has started passing through VIP Channel backward");
+    double ServiceStart = CurrentTime();
     sleep(Z);
     PrintWithTime("Passenger " + passenger->Identity + " has crossed VIP Channel backward");
+    RecordVisit(passenger, VIP_BACKWARD_STATION, ServiceStart - QueueEnter, CurrentTime() - ServiceStart);
 
     // Decrease right to left count
     pthread_mutex_lock(&rtl_count_mutex);
@@ -201,18 +411,63 @@ void RightToLeft(Passenger* passenger){
     pthread_mutex_unlock(&rtl_count_mutex);
 }
 
+// A function that tells a passenger has lost the boarding pass
+void LoseBoardingPass(Passenger* passenger){
+    pthread_mutex_lock(&print_mutex);
+    if(ConsoleOutput){
+        cout << "Passenger " << passenger->Identity << " has lost boarding pass" << endl; 
+    }
+    pthread_mutex_unlock(&print_mutex);
+}
+
+// A function that returns the boarding zone printed on the pass
+int BoardingZone(Passenger* passenger){
+    return passenger->PassengerID % BOARDING_ZONES;
+}
+
+// A function that simulates boarding in batches, the gate thread decides who goes in which batch
+void BatchBoarding(Passenger* passenger){
+    PrintWithTime("Passenger " + passenger->Identity + " has started waiting to be boarded");
+    double QueueEnter = CurrentTime();
+    passenger->HasBoardingPass = PassengerRandom(passenger, 1 + passenger->BoardingAttempts) % 3; // Randomly lose boarding pass
+
+    // A lost pass is noticed while joining the queue, the batch never waits for this passenger
+    if(passenger->HasBoardingPass == 0){
+        LoseBoardingPass(passenger);
+        RecordVisit(passenger, BOARDING_STATION, 0, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&gate_mutex);
+    GateQueue.push_back(passenger);
+    pthread_cond_signal(&gate_cond);
+    pthread_mutex_unlock(&gate_mutex);
+
+    sem_wait(&boarded_sem[passenger->PassengerID]); // Wait until the whole batch has boarded
+
+    passenger->BoardingComplete = 1; // Boarding complete for the passenger
+    RecordVisit(passenger, BOARDING_STATION, passenger->BatchAdmitted - QueueEnter, passenger->BatchShare);
+}
+
 // A function that simulates passenger boarding the plane
 void Boarding(Passenger* passenger){
+    if(BOARDING_MODE == BATCH_BOARDING){
+        BatchBoarding(passenger);
+        return;
+    }
+
+    double QueueEnter = CurrentTime();
     pthread_mutex_lock(&boarding_check_mutex); // Only one person can board at a time
+    double ServiceStart = CurrentTime();
 
     PrintWithTime("Passenger " + passenger->Identity + " has started waiting to be boarded");
-    passenger->HasBoardingPass = rand() % 3; // Randomly lose boarding pass
+    passenger->HasBoardingPass = PassengerRandom(passenger, 1 + passenger->BoardingAttempts) % 3; // Randomly lose boarding pass
 
     // If passenger loses boarding pass
     if(passenger->HasBoardingPass == 0){
-        pthread_mutex_lock(&print_mutex);
-        cout << "Passenger " << passenger->Identity << " has lost boarding pass" << endl; 
-        pthread_mutex_unlock(&print_mutex);
+        LoseBoardingPass(passenger);
+        RecordVisit(passenger, BOARDING_STATION, ServiceStart - QueueEnter, CurrentTime() - ServiceStart);
+        RecordGateHandoff(1, CurrentTime() - ServiceStart, 0);
         pthread_mutex_unlock(&boarding_check_mutex); // He needs to return to special kiosk, so this area is open again
         return;
     }
@@ -223,6 +478,8 @@ void Boarding(Passenger* passenger){
     PrintWithTime("Passenger " + passenger->Identity + " has boarded the plane");
 
     passenger->BoardingComplete = 1; // Boarding complete for the passenger
+    RecordVisit(passenger, BOARDING_STATION, ServiceStart - QueueEnter, CurrentTime() - ServiceStart);
+    RecordGateHandoff(1, CurrentTime() - ServiceStart, 0);
 
     pthread_mutex_unlock(&boarding_check_mutex);
 }
@@ -230,13 +487,16 @@ void Boarding(Passenger* passenger){
 // A function that simulates the special kiosk in case passenger loses boarding pass
 void SpecialKiosk(Passenger* passenger){
     PrintWithTime("Passenger " + passenger->Identity + " has arrived in front of special kiosk");
+    double QueueEnter = CurrentTime();
 
     pthread_mutex_lock(&special_kiosk_mutex); // Special kiosk can serve one person at a time
 
     // Do check up
     PrintWithTime("Passenger " + passenger->Identity + " has started self-check in special kiosk");
+    double ServiceStart = CurrentTime();
     sleep(W);
     PrintWithTime("Passenger " + passenger->Identity + " has finished self-check in special kiosk");
+    RecordVisit(passenger, SPECIAL_KIOSK_STATION, ServiceStart - QueueEnter, CurrentTime() - ServiceStart);
     
     pthread_mutex_unlock(&special_kiosk_mutex); // Check up in special kiosk done
 }
@@ -246,33 +506,29 @@ void SpecialKiosk(Passenger* passenger){
 // Passenger Thread
 void * PassengerProcess(void* arg_passenger){
     Passenger* passenger = (Passenger*) arg_passenger;
-    // Self Check In Kiosk
-    SelfCheckUp(passenger);
-
-    // Non VIP need Security Check
-    if(passenger->VIP == 0){
-        SecurityBeltnonVIP(passenger);
-    }else{
-        // VIP Has special channel
-        LeftToRight(passenger);
-    }
-
-    // Boarding
-    while(true){
-        Boarding(passenger);
 
-        // Boarding done
-        if(passenger->BoardingComplete == 1){
-            break;
-        }else{
-            // Only possible way the boarding is not done is when the pass is lost, so, return to special kiosk
-            RightToLeft(passenger);
-
-            // Then do checkup in special kiosk
-            SpecialKiosk(passenger);
-
-            // Then return via VIP Channel
-            LeftToRight(passenger);
+    // Visit stations until boarded, RecordVisit decides where to go next
+    // A passenger resumed from a checkpoint starts again at the station it was in
+    while(passenger->Stage != TOTAL_STATIONS){
+        switch(passenger->Stage){
+            case KIOSK_STATION:
+                SelfCheckUp(passenger); // Self Check In Kiosk
+                break;
+            case SECURITY_STATION:
+                SecurityBeltnonVIP(passenger);
+                break;
+            case VIP_FORWARD_STATION:
+                LeftToRight(passenger);
+                break;
+            case BOARDING_STATION:
+                Boarding(passenger);
+                break;
+            case VIP_BACKWARD_STATION:
+                RightToLeft(passenger);
+                break;
+            case SPECIAL_KIOSK_STATION:
+                SpecialKiosk(passenger); // Checkup in special kiosk after losing the pass
+                break;
         }
     }
     // Boarding done, safe journey 
@@ -281,50 +537,331 @@ void * PassengerProcess(void* arg_passenger){
 
 // Passenger Producer
 void * PassengerGenerator(void* argument){
-    int Counter = 0;
-    while(Counter < TOTAL_ARRIVALS){
+    for(int Counter=0; Counter<TOTAL_ARRIVALS; Counter++){
+        // Passengers that boarded before the checkpoint are not simulated again
+        if(AllPassenger[Counter].Stage == TOTAL_STATIONS){
+            continue;
+        }
+
         Passenger *passenger = new Passenger();
         passenger->CopyPassenger(AllPassenger[Counter]); // Had pointer issue so used copy
 
-        PrintWithTime("Passenger " + passenger->Identity + " has arrived at airport");
+        if(passenger->Arrived == 0){
+            SleepUntil(passenger->ArrivalTime);
+            PrintWithTime("Passenger " + passenger->Identity + " has arrived at airport");
+        }
+
+        pthread_mutex_lock(&statistics_mutex);
+        passenger->Arrived = 1;
+        ActivePassenger[Counter] = passenger;
+        pthread_mutex_unlock(&statistics_mutex);
 
-        pthread_t PassengerThread;
-        AllThreads[Counter] = PassengerThread;
         pthread_create(&AllThreads[Counter], NULL, PassengerProcess, (void*) passenger); // Create passenger thread
-        
-        // No need to sleep if it is the last passenger
-        if(Counter != TOTAL_ARRIVALS - 1){
-            int SleepTime = AllPassenger[Counter + 1].ArrivalTime - AllPassenger[Counter].ArrivalTime;
-            //cout << Counter << ": " << SleepTime << endl;
-            sleep(SleepTime);
-        }
-        Counter++;
     }
 
     for(int Counter=0; Counter<TOTAL_ARRIVALS; Counter++){
-        pthread_join(AllThreads[Counter], NULL);
+        if(ActivePassenger[Counter] != NULL){
+            pthread_join(AllThreads[Counter], NULL);
+        }
+    }
+
+    // Everyone has boarded, let the gate thread leave
+    pthread_mutex_lock(&gate_mutex);
+    GateClosed = true;
+    pthread_cond_broadcast(&gate_cond);
+    pthread_mutex_unlock(&gate_mutex);
+    if(ConsoleOutput){
+        cout << "Simulation done for " << TOTAL_ARRIVALS << " passengers" << endl;
     }
-    cout << "Simulation done for " << TOTAL_ARRIVALS << " passengers" << endl;
     if(OutputFile){
         OutputFile.close();
     }
+    SimulationFinished = true;
+    return (void *) 0;
+}
+
+// A function that returns how many waiting passengers the current policy could put in one batch, gate_mutex must be held
+int LargestBatch(){
+    if(BATCH_POLICY != ZONE_BATCH){
+        return GateQueue.size();
+    }
+    int Largest = 0;
+    for(int Zone=0; Zone<BOARDING_ZONES; Zone++){
+        int Count = 0;
+        for(Passenger* passenger : GateQueue){
+            Count += (BoardingZone(passenger) == Zone);
+        }
+        Largest = max(Largest, Count);
+    }
+    return Largest;
+}
+
+// A function that takes the next batch out of GateQueue, gate_mutex must be held
+vector<Passenger*> SelectBatch(){
+    vector<Passenger*> Candidates;
+    if(BATCH_POLICY == VIP_BATCH){
+        // VIP passengers go first, everyone keeps arrival order within the group
+        for(Passenger* passenger : GateQueue){
+            if(passenger->VIP == 1){
+                Candidates.push_back(passenger);
+            }
+        }
+        for(Passenger* passenger : GateQueue){
+            if(passenger->VIP == 0){
+                Candidates.push_back(passenger);
+            }
+        }
+    }else if(BATCH_POLICY == ZONE_BATCH){
+        // Zones are called in turn, skipping zones with nobody waiting
+        for(int Offset=0; Offset<BOARDING_ZONES && Candidates.empty(); Offset++){
+            int Zone = (NextZone + Offset) % BOARDING_ZONES;
+            for(Passenger* passenger : GateQueue){
+                if(BoardingZone(passenger) == Zone){
+                    Candidates.push_back(passenger);
+                }
+            }
+            if(!Candidates.empty()){
+                NextZone = (Zone + 1) % BOARDING_ZONES;
+            }
+        }
+    }else{
+        Candidates = GateQueue;
+    }
+
+    if(Candidates.size() > BATCH_SIZE){
+        Candidates.resize(BATCH_SIZE);
+    }
+    for(Passenger* passenger : Candidates){
+        GateQueue.erase(find(GateQueue.begin(), GateQueue.end(), passenger));
+    }
+    return Candidates;
+}
+
+// A function that boards one batch with a single service time and releases its passengers
+void BoardBatch(vector<Passenger*>& Batch, double Formation){
+    int ServiceTime = (BATCH_SERVICE_TIME > 0) ? BATCH_SERVICE_TIME : Y;
+    double ServiceStart = CurrentTime();
+
+    for(Passenger* passenger : Batch){
+        PrintWithTime("Passenger " + passenger->Identity + " has started boarding the plane");
+    }
+    sleep(ServiceTime);
+    for(Passenger* passenger : Batch){
+        PrintWithTime("Passenger " + passenger->Identity + " has boarded the plane");
+    }
+
+    double Busy = CurrentTime() - ServiceStart;
+    RecordGateHandoff(Batch.size(), Busy, Formation);
+    for(Passenger* passenger : Batch){
+        passenger->BatchAdmitted = ServiceStart;
+        passenger->BatchShare = Busy / Batch.size();
+        sem_post(&boarded_sem[passenger->PassengerID]);
+    }
+}
+
+// Boarding Gate Thread: forms batches from the waiting passengers until the gate closes
+void * BoardingGateProcess(void*){
+    pthread_mutex_lock(&gate_mutex);
+    while(true){
+        while(GateQueue.empty() && !GateClosed){
+            pthread_cond_wait(&gate_cond, &gate_mutex);
+        }
+        if(GateQueue.empty()){
+            break; // Closed and nobody is waiting
+        }
+
+        // The batch window opens with the first waiting passenger and ends when the batch is full or times out
+        double WindowStart = CurrentTime();
+        timespec Deadline;
+        clock_gettime(CLOCK_REALTIME, &Deadline);
+        Deadline.tv_sec += BATCH_TIMEOUT;
+        while(LargestBatch() < BATCH_SIZE && !GateClosed){
+            if(pthread_cond_timedwait(&gate_cond, &gate_mutex, &Deadline) == ETIMEDOUT){
+                break;
+            }
+        }
+        vector<Passenger*> Batch = SelectBatch();
+        double Formation = CurrentTime() - WindowStart;
+        pthread_mutex_unlock(&gate_mutex);
+
+        PrintWithTime("Batch of " + to_string(Batch.size()) + " passengers has been called to board");
+        BoardBatch(Batch, Formation);
+
+        pthread_mutex_lock(&gate_mutex);
+    }
+    pthread_mutex_unlock(&gate_mutex);
+    return (void *) 0;
+}
+
+/*-------------------------Checkpoint Functions-------------------------*/
+
+// A function that writes the whole simulation state to the checkpoint file
+// The file is written next to the old one and renamed over it, so an interrupted write never loses the last checkpoint
+void WriteCheckpoint(){
+    string TemporaryName = CheckpointFileName + ".tmp";
+    ofstream Checkpoint(TemporaryName);
+    if(!Checkpoint){
+        cout << "Cannot write checkpoint " << CheckpointFileName << endl;
+        return;
+    }
+
+    pthread_mutex_lock(&statistics_mutex);
+    Checkpoint << setprecision(17);
+    Checkpoint << "checkpoint 1" << endl;
+    Checkpoint << "seed " << Seed << endl;
+    Checkpoint << "clock " << CurrentTime() << endl;
+    Checkpoint << "input " << M << " " << N << " " << P << " " << W << " " << X << " " << Y << " " << Z << endl;
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        Checkpoint << "station " << Counter << " " << Statistics[Counter].Visits << " "
+                   << Statistics[Counter].TotalWait << " " << Statistics[Counter].TotalBusy << endl;
+    }
+    Checkpoint << "boarded " << PassengersBoarded << " " << TotalTimeInSystem << " " << LastBoardingTime << endl;
+    Checkpoint << "gate " << Gate.Handoffs << " " << Gate.Passengers << " " << Gate.Busy << " " << Gate.Formation << endl;
+
+    // Occupancy and queues are informational, a resumed passenger enters its station again and rebuilds them
+    int Available;
+    sem_getvalue(&kiosk_sem, &Available);
+    Checkpoint << "occupancy kiosk " << M - Available << endl;
+    for(int Counter=0; Counter<N; Counter++){
+        sem_getvalue(&security_belt_sem[Counter], &Available);
+        Checkpoint << "occupancy belt " << Counter << " " << P - Available << endl;
+    }
+    Checkpoint << "occupancy channel " << LTRCount << " " << RTLCount << endl;
+
+    int InStation[TOTAL_STATIONS + 1] = {0};
+    for(int Counter=0; Counter<TOTAL_ARRIVALS; Counter++){
+        Passenger* passenger = (ActivePassenger[Counter] != NULL) ? ActivePassenger[Counter] : &AllPassenger[Counter];
+        if(passenger->Arrived == 1){
+            InStation[passenger->Stage]++;
+        }
+        Checkpoint << "passenger " << passenger->PassengerID << " " << passenger->ArrivalTime << " " << passenger->VIP << " "
+                   << passenger->Arrived << " " << passenger->Stage << " " << passenger->BoardingAttempts << endl;
+    }
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        Checkpoint << "queue " << Counter << " " << InStation[Counter] << endl;
+    }
+    pthread_mutex_unlock(&statistics_mutex);
+
+    Checkpoint.close();
+    rename(TemporaryName.c_str(), CheckpointFileName.c_str());
+}
+
+// A function that restores the simulation state from the checkpoint file, returns false if there is none
+bool LoadCheckpoint(){
+    ifstream Checkpoint(CheckpointFileName);
+    if(!Checkpoint){
+        return false;
+    }
+
+    string Key;
+    int Version;
+    Checkpoint >> Key >> Version;
+    if(Key != "checkpoint" || Version != 1){
+        cout << "Unknown checkpoint format in " << CheckpointFileName << ", terminating" << endl;
+        exit(-1);
+    }
+
+    int Loaded = 0;
+    while(Checkpoint >> Key){
+        if(Key == "seed"){
+            Checkpoint >> Seed;
+        }else if(Key == "clock"){
+            Checkpoint >> ResumeClock;
+        }else if(Key == "input"){
+            Checkpoint >> M >> N >> P >> W >> X >> Y >> Z;
+        }else if(Key == "station"){
+            int Index;
+            if(!(Checkpoint >> Index) || Index < 0 || Index >= TOTAL_STATIONS){
+                cout << "Checkpoint does not match TOTAL_STATIONS, terminating" << endl;
+                exit(-1);
+            }
+            Checkpoint >> Statistics[Index].Visits >> Statistics[Index].TotalWait >> Statistics[Index].TotalBusy;
+        }else if(Key == "boarded"){
+            Checkpoint >> PassengersBoarded >> TotalTimeInSystem >> LastBoardingTime;
+        }else if(Key == "gate"){
+            Checkpoint >> Gate.Handoffs >> Gate.Passengers >> Gate.Busy >> Gate.Formation;
+        }else if(Key == "passenger"){
+            Passenger passenger;
+            Checkpoint >> passenger.PassengerID >> passenger.ArrivalTime >> passenger.VIP
+                       >> passenger.Arrived >> passenger.Stage >> passenger.BoardingAttempts;
+            passenger.Identity = to_string(passenger.PassengerID) + (passenger.VIP == 1 ? "(VIP)" : "");
+            if(!Checkpoint || passenger.PassengerID < 0 || passenger.PassengerID >= TOTAL_ARRIVALS){
+                cout << "Checkpoint does not match TOTAL_ARRIVALS, terminating" << endl;
+                exit(-1);
+            }
+            AllPassenger[passenger.PassengerID] = passenger;
+            Loaded++;
+        }else{
+            string Ignored;
+            getline(Checkpoint, Ignored); // Occupancy and queue lines are not needed to resume
+        }
+        if(!Checkpoint){
+            cout << "Truncated or malformed " << Key << " record in " << CheckpointFileName << ", terminating" << endl;
+            exit(-1);
+        }
+    }
+    if(Loaded != TOTAL_ARRIVALS){
+        cout << "Checkpoint does not match TOTAL_ARRIVALS, terminating" << endl;
+        exit(-1);
+    }
+    cout << "Resuming from " << CheckpointFileName << " at time " << (int) ResumeClock << endl;
+    return true;
+}
+
+// Checkpoint Thread: writes a checkpoint every CHECKPOINT_INTERVAL seconds and whenever SIGUSR1 arrives
+void * CheckpointProcess(void*){
+    sigset_t Signals;
+    sigemptyset(&Signals);
+    sigaddset(&Signals, SIGUSR1);
+    time_point<steady_clock> LastCheckpoint = steady_clock::now();
+
+    while(!SimulationFinished){
+        timespec Poll = {0, 200000000}; // Notice the end of the simulation within 200 ms
+        int Signal = sigtimedwait(&Signals, NULL, &Poll);
+        bool Due = CHECKPOINT_INTERVAL > 0 && steady_clock::now() - LastCheckpoint >= seconds(CHECKPOINT_INTERVAL);
+        if((Signal == SIGUSR1 || Due) && !SimulationFinished){
+            WriteCheckpoint();
+            LastCheckpoint = steady_clock::now();
+        }
+    }
     return (void *) 0;
 }
 
+// A function that runs the passenger generator and the checkpoint thread to completion
+void RunSimulation(){
+    // SIGUSR1 is only taken by the checkpoint thread, every thread created from here on inherits the mask
+    sigset_t Signals;
+    sigemptyset(&Signals);
+    sigaddset(&Signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &Signals, NULL);
+
+    pthread_t CheckpointThread;
+    pthread_create(&CheckpointThread, NULL, CheckpointProcess, NULL);
+
+    pthread_t GateThread;
+    if(BOARDING_MODE == BATCH_BOARDING){
+        pthread_create(&GateThread, NULL, BoardingGateProcess, NULL);
+    }
+
+    pthread_t GeneratorThread;
+    pthread_create(&GeneratorThread, NULL, PassengerGenerator, NULL);
+
+    pthread_join(GeneratorThread, NULL);
+    pthread_join(CheckpointThread, NULL);
+    if(BOARDING_MODE == BATCH_BOARDING){
+        pthread_join(GateThread, NULL);
+    }
+}
+
 /*-------------------------Initialization Functions-------------------------*/
 
-// A function that reads the input file and initializes the variables
-void InitializeVariables(){
+// A function that reads the values of M, N, P, W, X, Y and Z from the input file
+void ReadInputFile(){
     if(!fopen("input.txt", "r")){
         cout << "File not found" << endl;
         exit(-1);
     }
     fstream inputFile("input.txt");
-    OutputFile.open("output.txt");
-    if(!OutputFile){
-        cout << "Cannot create output file, terminating" << endl;
-        exit(-1);
-    }
     
     // Get values of M, N and P
     inputFile >> M >> N >> P;
@@ -333,6 +870,15 @@ void InitializeVariables(){
     inputFile.close();
 }
 
+// A function that opens the output file, a resumed run appends to the log of the interrupted one
+void InitializeOutputFile(){
+    OutputFile.open(OutputFileName, Resumed ? ios::app : ios::trunc);
+    if(!OutputFile){
+        cout << "Cannot create output file, terminating" << endl;
+        exit(-1);
+    }
+}
+
 // A function that initializes the necessary mutex and semaphores
 void InitializeSemaphoresAndMutex(){
     // Kiosk
@@ -359,19 +905,29 @@ void InitializeSemaphoresAndMutex(){
     // Boarding
     pthread_mutex_init(&boarding_check_mutex, NULL);
 
+    // Batched Boarding
+    pthread_mutex_init(&gate_mutex, NULL);
+    pthread_cond_init(&gate_cond, NULL);
+    for(int Counter=0; Counter<TOTAL_ARRIVALS; Counter++){
+        sem_init(&boarded_sem[Counter], 0, 0);
+    }
+
     // Special Kiosk
     pthread_mutex_init(&special_kiosk_mutex, NULL);
+
+    // Statistics
+    pthread_mutex_init(&statistics_mutex, NULL);
 }
 
 // A function that generates passenger arrival time based on poisson distribution
 void PassengerArrivalInitialization(){
-    srand(time(0));
+    srand(Seed);
     int TotalArrival = 0;
 
     double ArrivalRate = TOTAL_ARRIVALS / SIMULATION_TIME_MINUTES;
     double Lambda = 1.0 / ArrivalRate;
 
-    default_random_engine RandomEngine;
+    default_random_engine RandomEngine(Seed);
     poisson_distribution<int> Poisson(Lambda);
 
     for(int Counter = 0; Counter < TOTAL_ARRIVALS; Counter++){
@@ -392,10 +948,13 @@ void PassengerArrivalInitialization(){
     }
 }
 
-// A function that initializes time
+// A function that initializes time, a resumed run continues the clock of the checkpoint
 void InitializeCurrentTime(){
     FirstPassengerTime = AllPassenger[0].ArrivalTime;
     StartTime = steady_clock::now();
+    if(Resumed){
+        StartTime -= duration_cast<steady_clock::duration>(duration<double>(ResumeClock - FirstPassengerTime));
+    }
 }
 
 // A function that initializes required steps, might not be necessary though
@@ -408,22 +967,375 @@ void InitializeSteps(){
 
 // A function that handles all initializations
 void InitializeProgram(){
-    InitializeVariables();
+    ReadInputFile();
+    if(RESUME_FROM_CHECKPOINT){
+        Resumed = LoadCheckpoint();
+    }
+    if(!Resumed){
+        PassengerArrivalInitialization();
+    }
+    InitializeOutputFile();
     InitializeSemaphoresAndMutex();
-    PassengerArrivalInitialization();
     InitializeCurrentTime();
     InitializeSteps();
 }
 
 
+/*-------------------------Analytical Estimator-------------------------*/
+
+// Erlang C probability that an arrival has to wait in an M/M/c queue with offered load a
+double ErlangC(int Servers, double Load){
+    double Term = 1, Sum = 1; // Term holds a^k/k!
+    for(int k=1; k<Servers; k++){
+        Term *= Load / k;
+        Sum += Term;
+    }
+    double Last = Term * Load / Servers * Servers / (Servers - Load);
+    return Last / (Sum + Last);
+}
+
+// Allen-Cunneen approximation of the waiting time in a G/G/c queue
+double GGcWait(int Servers, double ArrivalRate, double ServiceTime, double ArrivalSCV, double ServiceSCV){
+    double Load = ArrivalRate * ServiceTime;
+    if(Load >= Servers){
+        return INFINITY;
+    }
+    if(Load == 0){
+        return 0;
+    }
+    return ErlangC(Servers, Load) * ServiceTime / (Servers - Load) * (ArrivalSCV + ServiceSCV) / 2.0;
+}
+
+// A function that models the airport as a queueing network and fills Estimate
+void ComputeEstimate(){
+    time_point<steady_clock> ComputeStart = steady_clock::now();
+
+    // Inter-arrival times are poisson distributed with mean Lambda, see PassengerArrivalInitialization
+    double MeanInterArrival = SIMULATION_TIME_MINUTES / TOTAL_ARRIVALS;
+    double Lambda = 1.0 / MeanInterArrival;
+    double ArrivalSCV = 1.0 / MeanInterArrival; // Variance of a poisson variable equals its mean
+    double Loss = BOARDING_PASS_LOSS_PROBABILITY;
+    double Retries = Loss / (1 - Loss); // Expected number of lost boarding passes per passenger
+
+    StationEstimate* Stations = Estimate.Stations;
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        Stations[Counter].Servers = StationServers(Counter);
+    }
+
+    // Self check in: M kiosks with deterministic service W
+    Stations[KIOSK_STATION].ArrivalRate = Lambda;
+    Stations[KIOSK_STATION].Wait = GGcWait(M, Lambda, W, ArrivalSCV, 0);
+
+    // Security: half the passengers are non VIP and pick one of N belts uniformly, each belt serves P at a time
+    double BeltRate = Lambda / 2.0 / N;
+    Stations[SECURITY_STATION].ArrivalRate = Lambda / 2.0;
+    Stations[SECURITY_STATION].Wait = GGcWait(P, BeltRate, X, 1, 0);
+
+    // Boarding: one passenger at a time, a lost pass releases the gate immediately
+    double AttemptRate = Lambda * (1 + Retries);
+    double BoardingLoad = Lambda * Y;
+    Stations[BOARDING_STATION].ArrivalRate = AttemptRate;
+    if(BoardingLoad < 1){
+        double SecondMoment = (1 - Loss) * Y * Y;
+        Stations[BOARDING_STATION].Wait = AttemptRate * SecondMoment / (2 * (1 - BoardingLoad)); // Pollaczek-Khinchine
+    }else{
+        Stations[BOARDING_STATION].Wait = INFINITY;
+    }
+
+    // Special kiosk: every lost pass is served once, deterministic service W
+    double SpecialRate = Lambda * Retries;
+    Stations[SPECIAL_KIOSK_STATION].ArrivalRate = SpecialRate;
+    Stations[SPECIAL_KIOSK_STATION].Wait = GGcWait(1, SpecialRate, W, 1, 0);
+
+    // VIP channel: passengers moving in the same direction share it, so each direction behaves as M/D/inf
+    // Backward passengers wait for a forward busy period, forward passengers only for a backward pass in progress
+    double ForwardRate = Lambda / 2.0 + SpecialRate;
+    double BackwardRate = SpecialRate;
+    Stations[VIP_FORWARD_STATION].ArrivalRate = ForwardRate;
+    Stations[VIP_BACKWARD_STATION].ArrivalRate = BackwardRate;
+    double ForwardBusy = 1 - exp(-ForwardRate * Z);
+    double BackwardBusy = 1 - exp(-BackwardRate * Z);
+    double ForwardBusyPeriod = (ForwardRate > 0) ? (exp(ForwardRate * Z) - 1) / ForwardRate : 0;
+    Stations[VIP_FORWARD_STATION].Wait = BackwardBusy * Z / 2.0;
+    Stations[VIP_BACKWARD_STATION].Wait = ForwardBusy * ForwardBusyPeriod;
+
+    // Utilization of every station
+    double ServiceTimes[TOTAL_STATIONS];
+    ServiceTimes[KIOSK_STATION] = W;
+    ServiceTimes[SECURITY_STATION] = X;
+    ServiceTimes[VIP_FORWARD_STATION] = Z;
+    ServiceTimes[VIP_BACKWARD_STATION] = Z;
+    ServiceTimes[BOARDING_STATION] = (1 - Loss) * Y;
+    ServiceTimes[SPECIAL_KIOSK_STATION] = W;
+
+    Estimate.Stable = true;
+    double Bottleneck = INFINITY; // Highest passenger rate the network can sustain
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        StationEstimate* Station = &Stations[Counter];
+        Station->Utilization = Station->ArrivalRate * ServiceTimes[Counter] / Station->Servers;
+        if(Counter == VIP_FORWARD_STATION || Counter == VIP_BACKWARD_STATION){
+            continue; // Shared by any number of passengers, reported as mean occupancy
+        }
+        if(Station->Utilization >= 1){
+            Estimate.Stable = false;
+        }
+        if(Station->Utilization > 0){
+            Bottleneck = min(Bottleneck, Lambda / Station->Utilization);
+        }
+    }
+    Estimate.Throughput = min(Lambda, Bottleneck);
+
+    // Expected time from arrival to boarding, weighted by how often each station is visited
+    Estimate.TimeInSystem = 0;
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        double Visits = Stations[Counter].ArrivalRate / Lambda;
+        Estimate.TimeInSystem += Visits * Stations[Counter].Wait;
+    }
+    Estimate.TimeInSystem += W + X / 2.0 + Z / 2.0 + Y + Retries * (Z + W + Z);
+
+    duration<double, micro> ComputeTime = steady_clock::now() - ComputeStart;
+    Estimate.ComputeMicroseconds = ComputeTime.count();
+}
+
+// A function to format a metric, infinite values mean the station is saturated
+string FormatMetric(double Value){
+    if(isinf(Value)){
+        return "unstable";
+    }
+    ostringstream Stream;
+    Stream << fixed << setprecision(2) << Value;
+    return Stream.str();
+}
+
+// A function that prints the analytical estimate
+void PrintEstimate(){
+    cout << "Analytical estimate computed in " << FormatMetric(Estimate.ComputeMicroseconds) << " microseconds" << endl;
+    cout << left << setw(16) << "Station" << setw(14) << "Utilization" << setw(14) << "Wait" << endl;
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        cout << setw(16) << StationNames[Counter]
+             << setw(14) << FormatMetric(Estimate.Stations[Counter].Utilization)
+             << setw(14) << FormatMetric(Estimate.Stations[Counter].Wait) << endl;
+    }
+    cout << "Throughput: " << FormatMetric(Estimate.Throughput) << " passengers per time unit" << endl;
+    cout << "Time in system: " << FormatMetric(Estimate.Stable ? Estimate.TimeInSystem : INFINITY) << endl;
+    cout << right;
+}
+
+// A function that summarizes what the simulation observed
+void CollectResult(ReplicationResult* Result){
+    double Makespan = LastBoardingTime - FirstPassengerTime;
+    Result->PassengersBoarded = PassengersBoarded;
+    if(PassengersBoarded == 0 || Makespan <= 0){
+        return;
+    }
+
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        StationStatistics* Observed = &Statistics[Counter];
+        Result->Utilization[Counter] = Observed->TotalBusy / (StationServers(Counter) * Makespan);
+        Result->Wait[Counter] = (Observed->Visits > 0) ? Observed->TotalWait / Observed->Visits : 0;
+    }
+    Result->Throughput = PassengersBoarded / Makespan;
+    Result->TimeInSystem = TotalTimeInSystem / PassengersBoarded;
+}
+
+// A function that prints the estimate next to what the simulation observed
+void PrintComparison(){
+    ReplicationResult Observed;
+    CollectResult(&Observed);
+    if(Observed.Throughput == 0){
+        cout << "Not enough observations to compare with the estimate" << endl;
+        return;
+    }
+
+    cout << left << setw(16) << "Station" << setw(12) << "Util(pred)" << setw(12) << "Util(obs)"
+         << setw(12) << "Wait(pred)" << setw(12) << "Wait(obs)" << setw(8) << "Visits" << endl;
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        StationEstimate* Predicted = &Estimate.Stations[Counter];
+        cout << setw(16) << StationNames[Counter]
+             << setw(12) << FormatMetric(Predicted->Utilization) << setw(12) << FormatMetric(Observed.Utilization[Counter])
+             << setw(12) << FormatMetric(Predicted->Wait) << setw(12) << FormatMetric(Observed.Wait[Counter])
+             << setw(8) << Statistics[Counter].Visits << endl;
+    }
+    cout << setw(16) << "Throughput" << setw(12) << FormatMetric(Estimate.Throughput)
+         << setw(12) << FormatMetric(Observed.Throughput) << endl;
+    cout << setw(16) << "Time in system" << setw(12) << FormatMetric(Estimate.Stable ? Estimate.TimeInSystem : INFINITY)
+         << setw(12) << FormatMetric(Observed.TimeInSystem) << endl;
+    cout << right;
+}
+
+
+// A function that prints how the boarding gate was used, to compare single and batched boarding
+void PrintBoardingSummary(){
+    if(Gate.Handoffs == 0){
+        return;
+    }
+    cout << "Boarding mode: " << (BOARDING_MODE == BATCH_BOARDING ? "batch" : "single") << endl;
+    cout << "Gate handoffs: " << Gate.Handoffs << ", passengers per handoff: " << FormatMetric((double) Gate.Passengers / Gate.Handoffs) << endl;
+    cout << "Gate busy: " << FormatMetric(Gate.Busy) << ", boarding throughput while busy: "
+         << FormatMetric(Gate.Busy > 0 ? PassengersBoarded / Gate.Busy : 0) << " passengers per time unit" << endl;
+    cout << "Mean gate wait: " << FormatMetric(Statistics[BOARDING_STATION].Visits > 0 ? Statistics[BOARDING_STATION].TotalWait / Statistics[BOARDING_STATION].Visits : 0)
+         << ", batch formation per handoff: " << FormatMetric(Gate.Formation / Gate.Handoffs) << endl;
+}
+
+
+/*-------------------------Replication Runner-------------------------*/
+
+// A function that runs one replication inside a forked worker and publishes its summary
+void RunReplicationWorker(int Index, unsigned int WorkerSeed, ReplicationResult* Result){
+    Seed = WorkerSeed;
+    OutputFileName = "output_" + to_string(Index + 1) + ".txt";
+    CheckpointFileName = "checkpoint_" + to_string(Index + 1) + ".txt";
+    ConsoleOutput = false;
+    InitializeProgram();
+    RunSimulation();
+
+    CollectResult(Result);
+    Result->Seed = Seed;
+    Result->Completed = 1;
+}
+
+// A function that prints mean, standard deviation and range of one metric over all completed replications
+void PrintAggregate(string Name, double Predicted, ReplicationResult* Results, double (*Metric)(ReplicationResult*, int), int Station){
+    int Count = 0;
+    double Sum = 0, SquareSum = 0, Minimum = INFINITY, Maximum = -INFINITY;
+    for(int Counter=0; Counter<REPLICATIONS; Counter++){
+        if(!Results[Counter].Completed){
+            continue;
+        }
+        double Value = Metric(&Results[Counter], Station);
+        Count++;
+        Sum += Value;
+        SquareSum += Value * Value;
+        Minimum = min(Minimum, Value);
+        Maximum = max(Maximum, Value);
+    }
+    if(Count == 0){
+        return;
+    }
+    double Mean = Sum / Count;
+    double Deviation = (Count > 1) ? sqrt(max(0.0, (SquareSum - Count * Mean * Mean) / (Count - 1))) : 0;
+
+    cout << setw(28) << Name;
+    if(ANALYTICAL_ESTIMATE){
+        cout << setw(12) << FormatMetric(Predicted);
+    }
+    cout << setw(12) << FormatMetric(Mean) << setw(12) << FormatMetric(Deviation)
+         << setw(12) << FormatMetric(Minimum) << setw(12) << FormatMetric(Maximum) << endl;
+}
+
+double ThroughputMetric(ReplicationResult* Result, int){ return Result->Throughput; }
+double TimeInSystemMetric(ReplicationResult* Result, int){ return Result->TimeInSystem; }
+double UtilizationMetric(ReplicationResult* Result, int Station){ return Result->Utilization[Station]; }
+double WaitMetric(ReplicationResult* Result, int Station){ return Result->Wait[Station]; }
+
+// A function that prints the aggregated results table
+void PrintReplicationSummary(ReplicationResult* Results){
+    int Completed = 0;
+    for(int Counter=0; Counter<REPLICATIONS; Counter++){
+        Completed += Results[Counter].Completed;
+    }
+    cout << Completed << " of " << REPLICATIONS << " replications completed" << endl;
+
+    cout << left << setw(28) << "Metric";
+    if(ANALYTICAL_ESTIMATE){
+        cout << setw(12) << "Predicted";
+    }
+    cout << setw(12) << "Mean" << setw(12) << "StdDev" << setw(12) << "Min" << setw(12) << "Max" << endl;
+
+    PrintAggregate("Throughput", Estimate.Throughput, Results, ThroughputMetric, 0);
+    PrintAggregate("Time in system", Estimate.Stable ? Estimate.TimeInSystem : INFINITY, Results, TimeInSystemMetric, 0);
+    for(int Counter=0; Counter<TOTAL_STATIONS; Counter++){
+        PrintAggregate(StationNames[Counter] + " util", Estimate.Stations[Counter].Utilization, Results, UtilizationMetric, Counter);
+        PrintAggregate(StationNames[Counter] + " wait", Estimate.Stations[Counter].Wait, Results, WaitMetric, Counter);
+    }
+    cout << right;
+}
+
+// A function that forks one worker per replication, at most one per online core at a time
+// Every worker owns a private copy of the globals, so replications cannot interfere
+void RunReplications(){
+    ReadInputFile();
+    if(ANALYTICAL_ESTIMATE){
+        ComputeEstimate();
+        PrintEstimate();
+    }
+
+    // The results table lives in memory shared with every worker
+    void* Shared = mmap(NULL, sizeof(ReplicationResult) * REPLICATIONS, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(Shared == MAP_FAILED){
+        cout << "Cannot create shared results table, terminating" << endl;
+        exit(-1);
+    }
+    ReplicationResult* Results = (ReplicationResult*) Shared;
+    for(int Counter=0; Counter<REPLICATIONS; Counter++){
+        Results[Counter] = ReplicationResult();
+    }
+
+    long Cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if(Cores < 1){
+        Cores = 1;
+    }
+
+    int Running = 0;
+    for(int Counter=0; Counter<REPLICATIONS; Counter++){
+        if(Running == Cores){
+            wait(NULL);
+            Running--;
+        }
+
+        unsigned int WorkerSeed = Seed + Counter;
+        cout << "Replication " << Counter + 1 << " started with seed " << WorkerSeed << endl;
+        pid_t WorkerID = fork();
+        if(WorkerID < 0){
+            cout << "Cannot fork replication " << Counter + 1 << endl;
+            break;
+        }
+        if(WorkerID == 0){
+            RunReplicationWorker(Counter, WorkerSeed, &Results[Counter]);
+            _exit(0);
+        }
+        Running++;
+    }
+    while(Running > 0){
+        wait(NULL);
+        Running--;
+    }
+
+    PrintReplicationSummary(Results);
+    munmap(Shared, sizeof(ReplicationResult) * REPLICATIONS);
+}
+
+
 /*-------------------------Main Function-------------------------*/
 
 int main(void){
+    // Estimate only: nothing is initialized, so the output file of the last run is left alone
+    if(!RUN_SIMULATION){
+        ReadInputFile();
+        if(ANALYTICAL_ESTIMATE){
+            ComputeEstimate();
+            PrintEstimate();
+        }
+        return 0;
+    }
+
+    if(REPLICATIONS > 1){
+        RunReplications();
+        return 0;
+    }
+
     InitializeProgram();
 
-    pthread_t GeneratorThread;
-    pthread_create(&GeneratorThread, NULL, PassengerGenerator, NULL);
+    if(ANALYTICAL_ESTIMATE){
+        ComputeEstimate();
+        PrintEstimate();
+    }
 
-    pthread_join(GeneratorThread, NULL);
+    RunSimulation();
+
+    PrintBoardingSummary();
+    if(ANALYTICAL_ESTIMATE){
+        PrintComparison();
+    }
 	return 0;
 }
\ No newline at end of file
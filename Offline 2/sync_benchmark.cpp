@@ -0,0 +1,438 @@
+// Microbenchmark for the synchronization primitives the airport simulator is built from
+// Compile: g++ -std=c++20 -O2 -pthread sync_benchmark.cpp -o sync_benchmark
+// Run: ./sync_benchmark [milliseconds per case] [maximum threads]
+#include<iostream>
+#include<iomanip>
+#include<string>
+#include<vector>
+#include<algorithm>
+#include<atomic>
+#include<thread>
+#include<mutex>
+#include<shared_mutex>
+#include<semaphore>
+#include<chrono>
+#include<pthread.h>
+#include<semaphore.h>
+#include<sched.h>
+#include<unistd.h>
+#include<linux/futex.h>
+#include<sys/syscall.h>
+
+#define DEFAULT_DURATION_MS 200
+#define DEFAULT_MAX_THREADS 64
+#define SEMAPHORE_PERMITS 4 // Like M kiosks or P slots of a security belt
+#define READ_PERCENT 90 // Share of shared (forward) acquisitions in reader-writer cases
+#define MAX_SAMPLES_PER_THREAD (1 << 18)
+#define SPIN_LIMIT 100 // Spins before a spin-then-park primitive goes to sleep
+using namespace std;
+using namespace chrono;
+
+/*-------------------------Utilities-------------------------*/
+
+// A function that burns roughly Amount units of CPU without touching shared memory
+void Work(int Amount){
+    for(int Counter=0; Counter<Amount; Counter++){
+        asm volatile("" ::: "memory"); // Keeps the compiler from removing the loop
+    }
+}
+
+// A function that tells the CPU we are busy waiting, yielding now and then so oversubscribed runs make progress
+void CpuRelax(int& Spins){
+    if(++Spins % 64 == 0){
+        sched_yield();
+    }else{
+        __builtin_ia32_pause();
+    }
+}
+
+long FutexWait(atomic<int>* Address, int Expected){
+    return syscall(SYS_futex, (int*) Address, FUTEX_WAIT_PRIVATE, Expected, NULL, NULL, 0);
+}
+
+long FutexWake(atomic<int>* Address, int Count){
+    return syscall(SYS_futex, (int*) Address, FUTEX_WAKE_PRIVATE, Count, NULL, NULL, 0);
+}
+
+/*-------------------------Semaphores-------------------------*/
+
+// The sem_t used for kiosks and security belts
+struct PosixSemaphore
+{
+    sem_t Semaphore;
+    PosixSemaphore(int Permits){ sem_init(&Semaphore, 0, Permits); }
+    ~PosixSemaphore(){ sem_destroy(&Semaphore); }
+    void Acquire(){ sem_wait(&Semaphore); }
+    void Release(){ sem_post(&Semaphore); }
+};
+
+struct StdSemaphore
+{
+    counting_semaphore<> Semaphore;
+    StdSemaphore(int Permits) : Semaphore(Permits){}
+    void Acquire(){ Semaphore.acquire(); }
+    void Release(){ Semaphore.release(); }
+};
+
+// A counting semaphore that spins briefly and then parks on a futex, waking only when someone is parked
+struct FutexSemaphore
+{
+    atomic<int> Count;
+    atomic<int> Waiters{0};
+    FutexSemaphore(int Permits) : Count(Permits){}
+
+    bool TryAcquire(){
+        int Current = Count.load(memory_order_relaxed);
+        while(Current > 0){
+            if(Count.compare_exchange_weak(Current, Current - 1, memory_order_acquire)){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Acquire(){
+        for(int Spins=0; Spins<SPIN_LIMIT; Spins++){
+            if(TryAcquire()){
+                return;
+            }
+            __builtin_ia32_pause();
+        }
+        // Announce the waiter before looking at Count again, and Release bumps Count before looking at
+        // Waiters. Both sides need a full fence between their write and read, or each can miss the other.
+        Waiters.fetch_add(1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        while(!TryAcquire()){
+            FutexWait(&Count, 0);
+        }
+        Waiters.fetch_sub(1, memory_order_relaxed);
+    }
+
+    void Release(){
+        Count.fetch_add(1, memory_order_seq_cst);
+        atomic_thread_fence(memory_order_seq_cst);
+        if(Waiters.load(memory_order_seq_cst) > 0){
+            FutexWake(&Count, 1);
+        }
+    }
+};
+
+/*-------------------------Mutexes-------------------------*/
+
+// The pthread_mutex_t used for boarding and the special kiosk
+struct PosixMutex
+{
+    pthread_mutex_t Mutex;
+    PosixMutex(int){ pthread_mutex_init(&Mutex, NULL); }
+    ~PosixMutex(){ pthread_mutex_destroy(&Mutex); }
+    void Acquire(){ pthread_mutex_lock(&Mutex); }
+    void Release(){ pthread_mutex_unlock(&Mutex); }
+};
+
+// 0 is unlocked, 1 is locked, 2 is locked with sleepers (Drepper, "Futexes Are Tricky")
+struct SpinThenParkMutex
+{
+    atomic<int> State{0};
+    SpinThenParkMutex(int){}
+
+    void Acquire(){
+        for(int Spins=0; Spins<SPIN_LIMIT; Spins++){
+            int Expected = 0;
+            if(State.compare_exchange_weak(Expected, 1, memory_order_acquire)){
+                return;
+            }
+            __builtin_ia32_pause();
+        }
+        while(State.exchange(2, memory_order_acquire) != 0){
+            FutexWait(&State, 2);
+        }
+    }
+
+    void Release(){
+        if(State.exchange(0, memory_order_release) == 2){
+            FutexWake(&State, 1);
+        }
+    }
+};
+
+/*-------------------------Reader Writer Locks-------------------------*/
+
+// The VIP channel: passengers going the same way share the channel, forward traffic keeps backward traffic out
+// Forward plays the reader, backward the writer, although backward passengers also share among themselves
+struct VIPChannelLock
+{
+    int LTRCount = 0;
+    int RTLCount = 0;
+    pthread_mutex_t ltr_count_mutex, rtl_count_mutex, vip_way_mutex, channel_mutex;
+
+    VIPChannelLock(){
+        pthread_mutex_init(&ltr_count_mutex, NULL);
+        pthread_mutex_init(&rtl_count_mutex, NULL);
+        pthread_mutex_init(&vip_way_mutex, NULL);
+        pthread_mutex_init(&channel_mutex, NULL);
+    }
+
+    void AcquireShared(){
+        pthread_mutex_lock(&ltr_count_mutex);
+        if(++LTRCount == 1){
+            pthread_mutex_lock(&vip_way_mutex);
+            pthread_mutex_lock(&channel_mutex);
+        }
+        pthread_mutex_unlock(&ltr_count_mutex);
+    }
+
+    void ReleaseShared(){
+        pthread_mutex_lock(&ltr_count_mutex);
+        if(--LTRCount == 0){
+            pthread_mutex_unlock(&vip_way_mutex);
+            pthread_mutex_unlock(&channel_mutex);
+        }
+        pthread_mutex_unlock(&ltr_count_mutex);
+    }
+
+    void AcquireExclusive(){
+        pthread_mutex_lock(&vip_way_mutex);
+        pthread_mutex_unlock(&vip_way_mutex);
+        pthread_mutex_lock(&rtl_count_mutex);
+        if(++RTLCount == 1){
+            pthread_mutex_lock(&channel_mutex);
+        }
+        pthread_mutex_unlock(&rtl_count_mutex);
+    }
+
+    void ReleaseExclusive(){
+        pthread_mutex_lock(&rtl_count_mutex);
+        if(--RTLCount == 0){
+            pthread_mutex_unlock(&channel_mutex);
+        }
+        pthread_mutex_unlock(&rtl_count_mutex);
+    }
+};
+
+struct StdSharedMutex
+{
+    shared_mutex Mutex;
+    void AcquireShared(){ Mutex.lock_shared(); }
+    void ReleaseShared(){ Mutex.unlock_shared(); }
+    void AcquireExclusive(){ Mutex.lock(); }
+    void ReleaseExclusive(){ Mutex.unlock(); }
+};
+
+// Phase-fair ticket lock (Brandenburg and Anderson, PF-T): readers and writers alternate phases
+struct PhaseFairLock
+{
+    static const unsigned READER_INCREMENT = 0x100;
+    static const unsigned WRITER_BITS = 0x3;
+    static const unsigned WRITER_PRESENT = 0x2;
+    static const unsigned PHASE_ID = 0x1;
+    atomic<unsigned> ReadersIn{0}, ReadersOut{0}, WritersIn{0}, WritersOut{0};
+
+    void AcquireShared(){
+        unsigned Writer = ReadersIn.fetch_add(READER_INCREMENT, memory_order_acquire) & WRITER_BITS;
+        int Spins = 0;
+        while(Writer != 0 && Writer == (ReadersIn.load(memory_order_acquire) & WRITER_BITS)){
+            CpuRelax(Spins);
+        }
+    }
+
+    void ReleaseShared(){
+        ReadersOut.fetch_add(READER_INCREMENT, memory_order_release);
+    }
+
+    void AcquireExclusive(){
+        unsigned Ticket = WritersIn.fetch_add(1, memory_order_relaxed);
+        int Spins = 0;
+        while(WritersOut.load(memory_order_acquire) != Ticket){
+            CpuRelax(Spins);
+        }
+        unsigned Writer = WRITER_PRESENT | (Ticket & PHASE_ID);
+        unsigned ReaderTicket = ReadersIn.fetch_add(Writer, memory_order_acquire);
+        while(ReadersOut.load(memory_order_acquire) != ReaderTicket){
+            CpuRelax(Spins);
+        }
+    }
+
+    void ReleaseExclusive(){
+        ReadersIn.fetch_and(~WRITER_BITS, memory_order_release);
+        WritersOut.fetch_add(1, memory_order_release);
+    }
+};
+
+/*-------------------------Benchmark Harness-------------------------*/
+
+struct Contention
+{
+    string Name;
+    int CriticalWork; // Work done while holding the primitive
+    int ThinkWork; // Work done between two acquisitions
+};
+
+const Contention ContentionLevels[] = {{"low", 50, 2000}, {"medium", 200, 200}, {"high", 500, 0}};
+
+struct CaseResult
+{
+    double OpsPerSecond = 0;
+    long P50 = 0, P99 = 0, P999 = 0, Max = 0; // Acquire latency in nanoseconds
+};
+
+// A function that reads a percentile out of sorted latencies
+long Percentile(vector<long>& Sorted, double Fraction){
+    if(Sorted.empty()){
+        return 0;
+    }
+    size_t Index = (size_t) (Fraction * (Sorted.size() - 1));
+    return Sorted[Index];
+}
+
+// A function that runs Threads workers for Duration, each repeatedly calling Operation(ThreadIndex, Latencies)
+template<typename Function>
+CaseResult RunCase(int Threads, milliseconds Duration, Function Operation){
+    atomic<bool> Start{false}, Stop{false};
+    vector<long> OpCounts(Threads, 0);
+    vector<vector<long>> Latencies(Threads);
+    vector<thread> Workers;
+
+    for(int Index=0; Index<Threads; Index++){
+        Workers.emplace_back([&, Index](){
+            Latencies[Index].reserve(MAX_SAMPLES_PER_THREAD);
+            unsigned Random = 2463534242u + Index * 7919u;
+            while(!Start.load(memory_order_acquire)){
+                this_thread::yield();
+            }
+            long Ops = 0;
+            while(!Stop.load(memory_order_relaxed)){
+                Random ^= Random << 13;
+                Random ^= Random >> 17;
+                Random ^= Random << 5;
+                long Latency = Operation(Random);
+                if(Latencies[Index].size() < MAX_SAMPLES_PER_THREAD){
+                    Latencies[Index].push_back(Latency);
+                }
+                Ops++;
+            }
+            OpCounts[Index] = Ops;
+        });
+    }
+
+    time_point<steady_clock> StartTime = steady_clock::now();
+    Start.store(true, memory_order_release);
+    this_thread::sleep_for(Duration);
+    Stop.store(true, memory_order_relaxed);
+    for(thread& Worker : Workers){
+        Worker.join();
+    }
+    duration<double> Elapsed = steady_clock::now() - StartTime;
+
+    CaseResult Result;
+    vector<long> All;
+    long TotalOps = 0;
+    for(int Index=0; Index<Threads; Index++){
+        TotalOps += OpCounts[Index];
+        All.insert(All.end(), Latencies[Index].begin(), Latencies[Index].end());
+    }
+    sort(All.begin(), All.end());
+    Result.OpsPerSecond = TotalOps / Elapsed.count();
+    Result.P50 = Percentile(All, 0.50);
+    Result.P99 = Percentile(All, 0.99);
+    Result.P999 = Percentile(All, 0.999);
+    Result.Max = All.empty() ? 0 : All.back();
+    return Result;
+}
+
+// A function that times one acquisition in nanoseconds
+template<typename Acquire>
+long TimedAcquire(Acquire Action){
+    time_point<steady_clock> Before = steady_clock::now();
+    Action();
+    return duration_cast<nanoseconds>(steady_clock::now() - Before).count();
+}
+
+void PrintHeader(){
+    cout << left << setw(22) << "Primitive" << setw(9) << "Threads" << setw(12) << "Contention" << right
+         << setw(15) << "Ops/sec" << setw(12) << "p50(ns)" << setw(12) << "p99(ns)"
+         << setw(12) << "p99.9(ns)" << setw(14) << "max(ns)" << endl;
+}
+
+void PrintRow(string Primitive, int Threads, const Contention& Level, CaseResult Result){
+    cout << left << setw(22) << Primitive << setw(9) << Threads << setw(12) << Level.Name << right
+         << setw(15) << fixed << setprecision(0) << Result.OpsPerSecond
+         << setw(12) << Result.P50 << setw(12) << Result.P99 << setw(12) << Result.P999
+         << setw(14) << Result.Max << endl;
+}
+
+// Semaphores and mutexes: acquire, do the critical work, release
+template<typename Primitive>
+void BenchmarkExclusive(string Name, int Permits, int Threads, const Contention& Level, milliseconds Duration){
+    Primitive Lock(Permits);
+    CaseResult Result = RunCase(Threads, Duration, [&](unsigned){
+        Work(Level.ThinkWork);
+        long Latency = TimedAcquire([&](){ Lock.Acquire(); });
+        Work(Level.CriticalWork);
+        Lock.Release();
+        return Latency;
+    });
+    PrintRow(Name, Threads, Level, Result);
+}
+
+// Reader-writer locks: READ_PERCENT of acquisitions are shared, the rest exclusive
+template<typename Primitive>
+void BenchmarkReaderWriter(string Name, int Threads, const Contention& Level, milliseconds Duration){
+    Primitive Lock;
+    CaseResult Result = RunCase(Threads, Duration, [&](unsigned Random){
+        Work(Level.ThinkWork);
+        long Latency;
+        if(Random % 100 < READ_PERCENT){
+            Latency = TimedAcquire([&](){ Lock.AcquireShared(); });
+            Work(Level.CriticalWork);
+            Lock.ReleaseShared();
+        }else{
+            Latency = TimedAcquire([&](){ Lock.AcquireExclusive(); });
+            Work(Level.CriticalWork);
+            Lock.ReleaseExclusive();
+        }
+        return Latency;
+    });
+    PrintRow(Name, Threads, Level, Result);
+}
+
+/*-------------------------Main Function-------------------------*/
+
+int main(int argc, char* argv[]){
+    milliseconds Duration(argc > 1 ? atoi(argv[1]) : DEFAULT_DURATION_MS);
+    int MaxThreads = argc > 2 ? atoi(argv[2]) : DEFAULT_MAX_THREADS;
+
+    vector<int> ThreadCounts;
+    for(int Threads=1; Threads<=MaxThreads; Threads*=2){
+        ThreadCounts.push_back(Threads);
+    }
+
+    cout << "Semaphores with " << SEMAPHORE_PERMITS << " permits" << endl;
+    PrintHeader();
+    for(const Contention& Level : ContentionLevels){
+        for(int Threads : ThreadCounts){
+            BenchmarkExclusive<PosixSemaphore>("sem_t", SEMAPHORE_PERMITS, Threads, Level, Duration);
+            BenchmarkExclusive<StdSemaphore>("std::counting_sem", SEMAPHORE_PERMITS, Threads, Level, Duration);
+            BenchmarkExclusive<FutexSemaphore>("futex_semaphore", SEMAPHORE_PERMITS, Threads, Level, Duration);
+        }
+    }
+
+    cout << endl << "Mutexes" << endl;
+    PrintHeader();
+    for(const Contention& Level : ContentionLevels){
+        for(int Threads : ThreadCounts){
+            BenchmarkExclusive<PosixMutex>("pthread_mutex_t", 1, Threads, Level, Duration);
+            BenchmarkExclusive<SpinThenParkMutex>("spin_then_park", 1, Threads, Level, Duration);
+        }
+    }
+
+    cout << endl << "Reader-writer locks with " << READ_PERCENT << "% shared acquisitions" << endl;
+    PrintHeader();
+    for(const Contention& Level : ContentionLevels){
+        for(int Threads : ThreadCounts){
+            BenchmarkReaderWriter<VIPChannelLock>("vip_channel", Threads, Level, Duration);
+            BenchmarkReaderWriter<StdSharedMutex>("std::shared_mutex", Threads, Level, Duration);
+            BenchmarkReaderWriter<PhaseFairLock>("phase_fair", Threads, Level, Duration);
+        }
+    }
+    return 0;
+}
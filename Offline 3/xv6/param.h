@@ -1,6 +1,13 @@
 #define NPROC        64  // maximum number of processes
 #define KSTACKSIZE 4096  // size of per-process kernel stack
 #define NCPU          8  // maximum number of CPUs
+#define BALANCETICKS  5  // ticks between two load balancing passes of a CPU
+#define TICKNS   10000000  // nanoseconds between two timer interrupts
+#define MAXCOMPENSATION 100  // compensation never raises a process's tickets more than this many times
+#define MAXTICKETS   100000  // tickets of one process or funding of one group, so run queue totals stay in an int
+#define MAXCOMPTICKETS 1000000  // compensation tickets of one process, so run queue totals stay in an int
+#define NGROUP       16  // ticket groups, including the base currency
+#define TRACESIZE   128  // scheduling events kept per CPU, a power of two
 #define NOFILE       16  // open files per process
 #define NFILE       100  // open files per system
 #define NINODE       50  // maximum number of active i-nodes
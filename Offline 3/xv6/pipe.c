@@ -17,6 +17,8 @@ struct pipe {
   uint nwrite;    // number of bytes written
   int readopen;   // read fd is still open
   int writeopen;  // write fd is still open
+  int readerpid;  // last process that read, a blocked writer lends it its tickets
+  int writerpid;  // last process that wrote, a blocked reader lends it its tickets
 };
 
 int
@@ -34,6 +36,8 @@ pipealloc(struct file **f0, struct file **f1)
   p->writeopen = 1;
   p->nwrite = 0;
   p->nread = 0;
+  p->readerpid = 0;
+  p->writerpid = 0;
   initlock(&p->lock, "pipe");
   (*f0)->type = FD_PIPE;
   (*f0)->readable = 1;
@@ -81,17 +85,21 @@ pipewrite(struct pipe *p, char *addr, int n)
   int i;
 
   acquire(&p->lock);
+  p->writerpid = myproc()->pid;
   for(i = 0; i < n; i++){
     while(p->nwrite == p->nread + PIPESIZE){  //DOC: pipewrite-full
       if(p->readopen == 0 || myproc()->killed){
+        returntickets();
         release(&p->lock);
         return -1;
       }
       wakeup(&p->nread);
+      lendtickets(p->readerpid);  // The reader runs with our tickets until there is room
       sleep(&p->nwrite, &p->lock);  //DOC: pipewrite-sleep
     }
     p->data[p->nwrite++ % PIPESIZE] = addr[i];
   }
+  returntickets();
   wakeup(&p->nread);  //DOC: pipewrite-wakeup1
   release(&p->lock);
   return n;
@@ -103,13 +111,17 @@ piperead(struct pipe *p, char *addr, int n)
   int i;
 
   acquire(&p->lock);
+  p->readerpid = myproc()->pid;
   while(p->nread == p->nwrite && p->writeopen){  //DOC: pipe-empty
     if(myproc()->killed){
+      returntickets();
       release(&p->lock);
       return -1;
     }
+    lendtickets(p->writerpid);  // The writer runs with our tickets until there is data
     sleep(&p->nread, &p->lock); //DOC: piperead-sleep
   }
+  returntickets();
   for(i = 0; i < n; i++){  //DOC: piperead-copy
     if(p->nread == p->nwrite)
       break;
@@ -5,8 +5,9 @@
 #include "mmu.h"
 #include "x86.h"
 #include "proc.h"
-#include "pseudorandom.h"
 #include "date.h"
+#include "pstat.h"
+#include "traps.h"
 
 static struct proc *initproc;
 
@@ -15,12 +16,473 @@ extern void forkret(void);
 extern void trapret(void);
 
 static void wakeup1(void *chan);
+static void setweight(struct proc *p, int tickets, int borrowed);
 struct ptable_info ptable;
 
+// Read-only to user space, mapped by mapstats()
+static union {
+  struct pstatpage stats;
+  char page[PGSIZE];
+} statspage __attribute__((aligned(PGSIZE)));
+
+// Publish a process's slot in the statistics page.
+// The ptable lock must be held, or the slot owned by the caller.
+static void
+statsupdate(struct proc *p)
+{
+  struct pstatslot *s = &statspage.stats.slot[p - ptable.proc];
+
+  s->seq++;
+  __sync_synchronize();
+  s->pid = p->pid;
+  s->tickets = p->procTickets;
+  s->state = p->state;
+  s->runtime = cyclestons(p->runcycles);
+  __sync_synchronize();
+  s->seq++;
+}
+
+// Runnable or running, the processes whose tickets fund their group's draws
+static int
+active(enum procstate state)
+{
+  return state == RUNNABLE || state == RUNNING;
+}
+
+// Base tickets a process's own tickets are worth. A group member holds
+// tickets in the group currency: the group's funding is split among its
+// active members by their tickets, so forking more members does not
+// raise the group's share of the CPU. An inactive member is valued as
+// if it were active. The ptable lock must be held.
+int
+basetickets(struct proc *p)
+{
+  struct ticketgroup *g = &ptable.group[p->group];
+  int tickets = p->procTickets, shares, base;
+
+  if(p->group == 0 || tickets <= 0)
+    return tickets;
+  shares = g->shares + (active(p->state) ? 0 : tickets);
+  // Scale both down until funding * tickets fits in an int
+  while(tickets > 0x7fffffff / g->funding){
+    tickets >>= 1;
+    shares >>= 1;
+  }
+  base = g->funding * tickets / shares;
+  return base > 0 ? base : 1;
+}
+
+// Tickets a process competes with, its own plus the compensation for its last run
+static int
+weight(struct proc *p)
+{
+  return basetickets(p) + p->compTickets + p->borrowedTickets;
+}
+
+// Record scheduling events, read unlocked in the scheduler
+static int tracing;
+
+// Record that c picked p with the given ticket. c->rqlock must be held.
+static void
+tracepick(struct cpu *c, struct proc *p, int ticket)
+{
+  struct traceevent *e = &c->trace.event[c->trace.head++ % TRACESIZE];
+  uint64 now = rdtsc();
+
+  e->time = div64(cyclestons(now), 1000);
+  e->wait = p->runnablesince && now > p->runnablesince ? div64(cyclestons(now - p->runnablesince), 1000) : 0;
+  e->cpu = c - cpus;
+  e->pid = p->pid;
+  e->ticket = ticket;
+  e->total = c->runnable.total;
+  e->runnable = c->runnable.size;
+  if(c->trace.head - c->trace.tail > TRACESIZE)
+    c->trace.tail = c->trace.head - TRACESIZE;
+}
+
+#if STRIDE
+// Pass comparison that survives the uint wrapping around
+static int
+passbefore(struct proc *a, struct proc *b)
+{
+  return (int)(a->pass - b->pass) < 0;
+}
+
+static void
+heapset(struct passheap *h, int i, struct proc *p)
+{
+  h->heap[i] = p;
+  p->heapindex = i;
+}
+
+// Move the process at i towards the top until its parent runs before it
+static void
+heapup(struct passheap *h, int i)
+{
+  struct proc *p = h->heap[i];
+
+  while(i > 0 && passbefore(p, h->heap[(i-1)/2])){
+    heapset(h, i, h->heap[(i-1)/2]);
+    i = (i-1)/2;
+  }
+  heapset(h, i, p);
+}
+
+// Move the process at i towards the bottom until it runs before its children
+static void
+heapdown(struct passheap *h, int i)
+{
+  struct proc *p = h->heap[i];
+  int child;
+
+  while((child = 2*i+1) < h->size){
+    if(child+1 < h->size && passbefore(h->heap[child+1], h->heap[child]))
+      child++;
+    if(!passbefore(h->heap[child], p))
+      break;
+    heapset(h, i, h->heap[child]);
+    i = child;
+  }
+  heapset(h, i, p);
+}
+
+// Put a process into the run queue of its CPU.
+// A process that fell behind the queue's virtual time, by sleeping or
+// being new, starts from it so it can not monopolize the CPU.
+static void
+queueinsert(struct proc *p)
+{
+  struct passheap *h = &cpus[p->cpu].runnable;
+
+  acquire(&cpus[p->cpu].rqlock);
+  if((int)(p->pass - h->vtime) < 0)
+    p->pass = h->vtime;
+  heapset(h, h->size++, p);
+  heapup(h, p->heapindex);
+  p->queuedweight = weight(p);
+  h->total += p->queuedweight;
+  release(&cpus[p->cpu].rqlock);
+}
+
+// Take a process out of the run queue of its CPU
+static void
+queueremove(struct proc *p)
+{
+  struct passheap *h = &cpus[p->cpu].runnable;
+  int i = p->heapindex;
+
+  acquire(&cpus[p->cpu].rqlock);
+  h->size--;
+  if(i != h->size){
+    heapset(h, i, h->heap[h->size]);
+    heapdown(h, i);
+    heapup(h, h->heap[i]->heapindex);
+  }
+  h->total -= p->queuedweight;
+  release(&cpus[p->cpu].rqlock);
+}
+
+// The process with the smallest pass, its pass advances in queuerun.
+// Returns 0 when the queue is empty. Needs only c->rqlock.
+static struct proc*
+queuepick(struct cpu *c)
+{
+  struct proc *p = 0;
+
+  acquire(&c->rqlock);
+  if(c->runnable.size > 0){
+    p = c->runnable.heap[0];
+    if(tracing)
+      tracepick(c, p, p->pass);
+  }
+  release(&c->rqlock);
+  return p;
+}
+
+// Start a run of p, just taken out of the run queue of c: the queue's
+// virtual time moves to p's pass, which then advances by p's stride.
+// The ptable lock must be held.
+static void
+queuerun(struct cpu *c, struct proc *p)
+{
+  acquire(&c->rqlock);
+  c->runnable.vtime = p->pass;
+  p->pass += STRIDE1 / (weight(p) > 0 ? weight(p) : 1);
+  release(&c->rqlock);
+}
+#else
+// Add delta to the tickets of ptable slot
+static void
+treeadd(struct ticketree *t, int slot, int delta)
+{
+  int i;
+
+  t->total += delta;
+  for(i = slot + 1; i <= NPROC; i += i & -i)
+    t->tree[i] += delta;
+}
+
+// Find the slot holding the winning ticket, 1 <= ticket <= t->total.
+// Walks down the tree from the highest power of two, keeping the
+// largest prefix whose ticket sum is still below the winning ticket.
+static int
+treefind(struct ticketree *t, int ticket)
+{
+  int pos = 0, step;
+
+  for(step = 1; step * 2 <= NPROC; step *= 2)
+    ;
+  for(; step > 0; step /= 2){
+    if(pos + step <= NPROC && t->tree[pos + step] < ticket){
+      pos += step;
+      ticket -= t->tree[pos];
+    }
+  }
+  return pos;
+}
+
+// Add delta to the tickets of a process in the run queue of its CPU,
+// and count processes to the number of processes there
+static void
+queueadd(struct proc *p, int delta, int count)
+{
+  struct cpu *c = &cpus[p->cpu];
+
+  acquire(&c->rqlock);
+  treeadd(&c->runnable, p - ptable.proc, delta);
+  c->runnable.size += count;
+  release(&c->rqlock);
+}
+
+// Put a process into the run queue of its CPU
+static void
+queueinsert(struct proc *p)
+{
+  p->queuedweight = weight(p);
+  queueadd(p, p->queuedweight, 1);
+}
+
+// Take a process out of the run queue of its CPU
+static void
+queueremove(struct proc *p)
+{
+  queueadd(p, -p->queuedweight, -1);
+}
+
+// Hold the lottery among the runnable processes of c.
+// Returns 0 when the queue is empty. Needs only c->rqlock.
+static struct proc*
+queuepick(struct cpu *c)
+{
+  struct proc *p = 0;
+
+  acquire(&c->rqlock);
+  if(c->runnable.total > 0){
+    // Get lottery winner
+    int winnerTicket = randUpTo(&c->rng, c->runnable.total) + 1; 
+    p = &ptable.proc[treefind(&c->runnable, winnerTicket)];
+    if(tracing)
+      tracepick(c, p, winnerTicket);
+  }
+  release(&c->rqlock);
+  return p;
+}
+
+// Start a run of p, just taken out of the run queue of c.
+// A lottery keeps nothing from one draw to the next.
+static void
+queuerun(struct cpu *c, struct proc *p)
+{
+}
+#endif
+
+// Add delta to the active tickets of a group. The base tickets of every
+// member change with them, so its runnable members are queued again,
+// except skip, which the caller queues itself. The ptable lock must be held.
+static void
+groupshares(int group, int delta, struct proc *skip)
+{
+  struct proc *p;
+
+  ptable.group[group].shares += delta;
+  for(p = ptable.group[group].first; p; p = p->groupnext){
+    if(p->state == RUNNABLE && p != skip){
+      queueremove(p);
+      queueinsert(p);
+    }
+  }
+}
+
+// Wake c with an IPI if it is halted with an empty run queue.
+// Called after a process was queued there: taking rqlock in both
+// queueinsert and idle orders the insert against the check of idle.
+static void
+kick(struct cpu *c)
+{
+  if(c->idle && c != mycpu())
+    lapicipi(c->apicid, T_IRQ0 + IRQ_WAKEUP);
+}
+
+// Change the state of a process, keeping the run queue of its CPU
+// and the active tickets of its group in sync.
+// The ptable lock must be held.
+static void
+setstate(struct proc *p, enum procstate state)
+{
+  enum procstate old = p->state;
+
+  if(old == RUNNABLE && state != RUNNABLE)
+    queueremove(p);
+  p->state = state;
+  if(p->group && active(old) != active(state))
+    groupshares(p->group, active(state) ? p->procTickets : -p->procTickets, p);
+  if(old != RUNNABLE && state == RUNNABLE){
+    p->runnablesince = tracing ? rdtsc() : 0;
+    queueinsert(p);
+    kick(&cpus[p->cpu]);
+  }
+  statsupdate(p);
+}
+
+// Ticket total of a CPU's run queue
+static int
+queuetotal(struct cpu *c)
+{
+  int total;
+
+  acquire(&c->rqlock);
+  total = c->runnable.total;
+  release(&c->rqlock);
+  return total;
+}
+
+// Halt c until the next interrupt: its timer tick, or the IPI sent
+// by kick when a process is queued here. The queue is looked at again
+// after idle is set, so a process queued in between is not missed.
+// Returns with interrupts enabled.
+static void
+idle(struct cpu *c)
+{
+  uint64 start;
+
+  cli();
+  c->idle = 1;
+  if(queuetotal(c) == 0){
+    start = rdtsc();
+    stihlt();
+    c->idlecycles += rdtsc() - start;
+  }
+  c->idle = 0;
+  sti();
+}
+
+// Tickets a CPU has to serve: its run queue, which leaves out the
+// process it is running, plus that process. The ptable lock must be held.
+static int
+cpuload(struct cpu *c)
+{
+  return queuetotal(c) + (c->proc ? weight(c->proc) : 0);
+}
+
+// The started CPU with the fewest tickets to serve, new processes are queued there.
+// Before any CPU has started every process goes to the first one.
+// The ptable lock must be held.
+static int
+leastloaded(void)
+{
+  int i, best = 0, besttotal = -1, total;
+
+  for(i = 0; i < ncpu; i++){
+    if(!cpus[i].started)
+      continue;
+    total = cpuload(&cpus[i]);
+    if(besttotal < 0 || total < besttotal){
+      best = i;
+      besttotal = total;
+    }
+  }
+  return best;
+}
+
+// Move runnable tickets from the busiest CPU to c when their loads
+// are too far apart. The process moved is the one whose tickets are
+// closest to half the difference, so the gap always shrinks. The loads
+// count the running processes, so an idle CPU takes the process queued
+// behind a running one.
+// The ptable lock must be held.
+static void
+balance(struct cpu *c)
+{
+  struct proc *p, *move = 0;
+  int i, busiest = -1, busiesttotal = 0, mytotal, gap, total, dist, movedist = 0;
+
+  mytotal = cpuload(c);
+  for(i = 0; i < ncpu; i++){
+    total = cpuload(&cpus[i]);
+    if(&cpus[i] != c && total > busiesttotal){
+      busiest = i;
+      busiesttotal = total;
+    }
+  }
+
+  gap = busiesttotal - mytotal;
+  if(busiest < 0 || gap <= 1)
+    return;
+
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if(p->state != RUNNABLE || p->cpu != busiest || weight(p) <= 0 || weight(p) >= gap)
+      continue;
+    dist = 2*weight(p) - gap;
+    if(dist < 0)
+      dist = -dist;
+    if(move == 0 || dist < movedist){
+      move = p;
+      movedist = dist;
+    }
+  }
+
+  if(move){
+    queueremove(move);
+#if STRIDE
+    // Keep the lead or lag the process had on its old CPU
+    move->pass = move->pass - cpus[busiest].runnable.vtime + c->runnable.vtime;
+#endif
+    move->cpu = c - cpus;
+    queueinsert(move);
+  }
+}
+
+// Compensation tickets: a process that gave up the CPU after using only a
+// fraction f of its quantum competes with basetickets/f tickets until it wins again.
+// f is kept in thousandths of the quantum measured by the timer interrupt.
+// The tickets are capped at MAXCOMPTICKETS so run queue totals stay in an int.
+// The ptable lock must be held, and a sleeping process is in no run queue.
+static void
+compensate(struct proc *p, uint64 used)
+{
+  uint usage = 1000, cyclesperusage = cyclespertick / 1000;
+  uint64 comp;
+
+  if(cyclesperusage > 0 && used < (uint64)cyclesperusage * 1000)
+    usage = (uint)used / cyclesperusage;
+  p->usage = usage;
+
+  if(p->state != SLEEPING || usage == 1000)
+    return;
+  if(usage < 1000 / MAXCOMPENSATION)
+    usage = 1000 / MAXCOMPENSATION;
+  comp = div64((uint64)basetickets(p) * 1000, usage) - basetickets(p);
+  p->compTickets = comp > MAXCOMPTICKETS ? MAXCOMPTICKETS : comp;
+}
+
 void
 pinit(void)
 {
+  int i;
+
   initlock(&ptable.lock, "ptable");
+  for(i = 0; i < NCPU; i++)
+    initlock(&cpus[i].rqlock, "runqueue");
 }
 
 // Must be called with interrupts disabled
@@ -85,12 +547,14 @@ allocproc(void)
 found:
   p->state = EMBRYO;
   p->pid = nextpid++;
+  statsupdate(p);
 
   release(&ptable.lock);
 
   // Allocate kernel stack.
   if((p->kstack = kalloc()) == 0){
     p->state = UNUSED;
+    statsupdate(p);
     return 0;
   }
   sp = p->kstack + KSTACKSIZE;
@@ -145,7 +609,9 @@ userinit(void)
   // because the assignment might not be atomic.
   acquire(&ptable.lock);
 
-  p->state = RUNNABLE;
+  p->cpu = 0;
+  p->pass = 0;
+  setstate(p, RUNNABLE);
 
   release(&ptable.lock);
 }
@@ -191,13 +657,19 @@ fork(void)
     kfree(np->kstack);
     np->kstack = 0;
     np->state = UNUSED;
+    statsupdate(np);
     return -1;
   }
   np->sz = curproc->sz;
   np->parent = curproc;
   *np->tf = *curproc->tf;
 
-  // Child should have same number of tickets as parent
+  // Child should have same number of tickets as parent, and no compensation or loans.
+  // It joins the parent's group once it is runnable.
+  np->compTickets = 0;
+  np->borrowedTickets = 0;
+  np->lentTo = 0;
+  np->group = 0;
   //cprintf("Parent: %d, Child: %d, ParentTicket: %d, ChildTicket: %d\n", curproc->pid, np->pid, curproc->procTickets, np->procTickets);
   setticketsutil(np, curproc->procTickets); 
 
@@ -215,7 +687,12 @@ fork(void)
 
   acquire(&ptable.lock);
 
-  np->state = RUNNABLE;
+  np->cpu = leastloaded();
+#if STRIDE
+  np->pass = cpus[np->cpu].runnable.vtime;
+#endif
+  setgroup(np, curproc->group);
+  setstate(np, RUNNABLE);
 
   release(&ptable.lock);
 
@@ -249,11 +726,14 @@ exit(void)
   curproc->cwd = 0;
 
   // Dead process needs no lottery
+  returntickets();
   setticketsutil(curproc, 0); 
   //curproc->ticks = 0;
 
   acquire(&ptable.lock);
 
+  setgroup(curproc, 0);
+
   // Parent might be sleeping in wait().
   wakeup1(curproc->parent);
 
@@ -267,7 +747,7 @@ exit(void)
   }
 
   // Jump into the scheduler, never to return.
-  curproc->state = ZOMBIE;
+  setstate(curproc, ZOMBIE);
   sched();
   panic("zombie exit");
 }
@@ -299,13 +779,16 @@ wait(void)
         p->parent = 0;
         p->name[0] = 0;
         p->killed = 0;
+
+        // zombie child, no tickets needed anymore. Reset while the lock is
+        // held, another CPU may allocate the slot as soon as it is UNUSED.
+        setweight(p, 0, 0);
+        p->ticks = 0;
+        p->runcycles = 0;
         p->state = UNUSED;
+        statsupdate(p);
 
         release(&ptable.lock);
-
-        // zombie child, no tickets needed anymore
-        setticketsutil(p, 0); 
-        p->ticks = 0;
         return pid;
       }
     }
@@ -332,15 +815,15 @@ wait(void)
 void
 scheduler(void)
 {
-  // Seed the RNG
-  struct rtcdate date; 
-  cmostime(&date); 
-  srand(date.second); 
-
   struct proc *p; 
   struct cpu *c = mycpu(); 
   c->proc = 0; 
 
+  // Seed this CPU's RNG from the wall clock and the TSC, on its own stream
+  struct rtcdate date; 
+  cmostime(&date); 
+  srand(&c->rng, (date.second + 60*(date.minute + 60*(date.hour + 24*date.day))) ^ rdtsc(), c - cpus); 
+
   // Set ticket count of init to 1
   setticketsutil(ptable.proc, 1); 
   
@@ -348,34 +831,33 @@ scheduler(void)
     // Enable interrupts on this processor.
     sti();
 
-    // Loop over process table looking for process to run.
-    acquire(&ptable.lock);
-    int totalTickets = 0; 
-    
-    // Get total tickets of runnable processes
-    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){ 
-      if(p->state == RUNNABLE){ 
-        totalTickets += p->procTickets; 
-      } 
-    } 
-
-    // Get lottery winner
-    int winnerTicket = randUpTo(totalTickets+1); 
-    int winnerTracker = 0; 
+    // An idle CPU only looks at its own run queue, and balances at most once a tick.
+    // ticks is read without tickslock, a stale value only delays a balancing pass.
+    int total = queuetotal(c);
+    if(ticks - c->lastbalance >= (total == 0 ? 1 : BALANCETICKS)){
+      c->lastbalance = ticks;
+      acquire(&ptable.lock);
+      balance(c);
+      release(&ptable.lock);
+      total = queuetotal(c);
+    }
+    if(total == 0){
+      idle(c);
+      continue;
+    }
 
-    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
-      if(p->state != RUNNABLE)
-      {  
-        continue; 
-      } 
+    // Draw from this CPU's run queue under its rqlock only, so CPUs do not
+    // serialize on ptable.lock to pick. ptable.lock is still taken for the
+    // switch: the process releases it in forkret or after sched returns,
+    // which is what keeps sleep and wakeup from losing a wakeup.
+    p = queuepick(c);
+    if(p == 0)
+      continue;
 
-      // Add the tickets owned by current process to the amount of total tickets
-      winnerTracker+=p->procTickets; 
+    acquire(&ptable.lock);
 
-      // Check if the process is not the winner
-      if(winnerTracker < winnerTicket){ 
-        continue; 
-      } 
+    // Another CPU's balance may have moved the winner before the lock was taken
+    if(p->state == RUNNABLE && p->cpu == c - cpus){
 
       // The process in this code region is the winner process
 
@@ -384,26 +866,27 @@ scheduler(void)
       // before jumping back to us.
       c->proc = p; 
       switchuvm(p); 
-      p->state = RUNNING; 
+      setstate(p, RUNNING); 
+      queuerun(c, p);
+      p->compTickets = 0; // Compensation only lasts until the next win
 
-      // Start tracking
-      int StartTick; 
+      // Start tracking, the run is timed by this CPU's TSC.
+      // ticks is read without tickslock, a tick that lands while reading only moves to the next run.
       p->inuse = 1; 
-      
-      acquire(&tickslock); 
-      StartTick = ticks; 
-      release(&tickslock); 
+      int StartTick = ticks; 
+      uint64 StartCycles = rdtsc();
 
       swtch(&(c->scheduler), p->context);
 
+      uint64 UsedCycles = rdtsc() - StartCycles;
+      int EndTick = ticks;  
+
       // Stop tracking
       p->inuse = 0; 
-
-      acquire(&tickslock); 
-      int EndTick = ticks;  
-      release(&tickslock); 
-      
+      p->runcycles += UsedCycles;
       p->ticks += EndTick - StartTick; 
+      statsupdate(p);
+      compensate(p, UsedCycles);
       //cprintf("Start: %d, End: %d, Tick: %d\n", StartTick, EndTick, p->ticks);
 
       switchkvm();
@@ -411,9 +894,6 @@ scheduler(void)
       // Process is done running for now.
       // It should have changed its p->state before coming back.
       c->proc = 0;
-
-      // Current lottery is done, so break out
-      break; 
     }
     release(&ptable.lock);
 
@@ -451,7 +931,7 @@ void
 yield(void)
 {
   acquire(&ptable.lock);  //DOC: yieldlock
-  myproc()->state = RUNNABLE;
+  setstate(myproc(), RUNNABLE);
   sched();
   release(&ptable.lock);
 }
@@ -502,7 +982,7 @@ sleep(void *chan, struct spinlock *lk)
   }
   // Go to sleep.
   p->chan = chan;
-  p->state = SLEEPING;
+  setstate(p, SLEEPING);
 
   sched();
 
@@ -526,7 +1006,7 @@ wakeup1(void *chan)
 
   for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
     if(p->state == SLEEPING && p->chan == chan)
-      p->state = RUNNABLE;
+      setstate(p, RUNNABLE);
 }
 
 // Wake up all processes sleeping on chan.
@@ -552,7 +1032,7 @@ kill(int pid)
       p->killed = 1;
       // Wake process from sleep if necessary.
       if(p->state == SLEEPING)
-        p->state = RUNNABLE;
+        setstate(p, RUNNABLE);
       release(&ptable.lock);
       return 0;
     }
@@ -598,12 +1078,213 @@ procdump(void)
   }
 }
 
+// Change the tickets a process owns and the tickets it borrows.
+// A run queue holds a process by its weight, so a runnable process leaves it meanwhile.
+// The ptable lock must be held.
+static void
+setweight(struct proc *p, int tickets, int borrowed)
+{
+  if(p->state == RUNNABLE)
+    queueremove(p);
+  if(p->group && active(p->state))
+    groupshares(p->group, tickets - p->procTickets, p);
+  p->procTickets = tickets;
+  p->borrowedTickets = borrowed;
+  if(p->state == RUNNABLE)
+    queueinsert(p);
+  statsupdate(p);
+}
+
+// A live process with the given pid, or 0. The ptable lock must be held.
+static struct proc*
+findlive(int pid)
+{
+  struct proc *p;
+
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    if(p->pid == pid && (p->state == RUNNABLE || p->state == RUNNING || p->state == SLEEPING))
+      return p;
+  return 0;
+}
+
 int 
 setticketsutil(struct proc* process, int tickets)
 {
   //Lock, as shared data will be accessed for scheduling
   acquire(&ptable.lock);
-  process->procTickets = tickets;
+  setweight(process, tickets, process->borrowedTickets);
   release(&ptable.lock);
   return 0;
-}
\ No newline at end of file
+}
+
+// Move tickets from the calling process to the process with the given pid.
+// The tickets are counted in the currency of whichever group each one is in.
+// Returns the tickets the caller has left, or -1 when the caller would be left with none
+// or the receiver with more than MAXTICKETS.
+int
+transferticketsutil(int pid, int tickets)
+{
+  struct proc *p, *curproc = myproc();
+  int left = -1;
+
+  acquire(&ptable.lock);
+  p = findlive(pid);
+  if(p && p != curproc && tickets < curproc->procTickets && p->procTickets <= MAXTICKETS - tickets){
+    setweight(curproc, curproc->procTickets - tickets, curproc->borrowedTickets);
+    setweight(p, p->procTickets + tickets, p->borrowedTickets);
+    left = curproc->procTickets;
+  }
+  release(&ptable.lock);
+  return left;
+}
+
+// Lend the current process's tickets to the process with the given pid
+// while the current process is blocked waiting on it, like a pipe reader
+// on the writer. Only the process's own tickets are lent, once, in base tickets.
+void
+lendtickets(int pid)
+{
+  struct proc *p, *curproc = myproc();
+
+  acquire(&ptable.lock);
+  p = findlive(pid);
+  if(curproc->lentTo == 0 && p && p != curproc){
+    curproc->lentTo = p;
+    curproc->lentPid = pid;
+    curproc->lentTickets = basetickets(curproc);
+    setweight(p, p->procTickets, p->borrowedTickets + curproc->lentTickets);
+  }
+  release(&ptable.lock);
+}
+
+// Take back the tickets lent by lendtickets, if the borrower is still the same process
+void
+returntickets(void)
+{
+  struct proc *p, *curproc = myproc();
+
+  acquire(&ptable.lock);
+  p = curproc->lentTo;
+  if(p && p->pid == curproc->lentPid)
+    setweight(p, p->procTickets, p->borrowedTickets - curproc->lentTickets);
+  curproc->lentTo = 0;
+  release(&ptable.lock);
+}
+
+// Move a process into a group, 0 being the base currency.
+// The ptable lock must be held.
+void
+setgroup(struct proc *p, int group)
+{
+  struct proc **member;
+
+  if(p->state == RUNNABLE)
+    queueremove(p);
+  if(p->group){
+    if(active(p->state))
+      groupshares(p->group, -p->procTickets, p);
+    for(member = &ptable.group[p->group].first; *member != p; member = &(*member)->groupnext)
+      ;
+    *member = p->groupnext;
+    if(--ptable.group[p->group].members == 0)
+      ptable.group[p->group].inuse = 0;
+  }
+  p->group = group;
+  if(group){
+    p->groupnext = ptable.group[group].first;
+    ptable.group[group].first = p;
+    ptable.group[group].members++;
+    if(active(p->state))
+      groupshares(group, p->procTickets, p);
+  }
+  if(p->state == RUNNABLE)
+    queueinsert(p);
+}
+
+// Create a group funded with the given base tickets and move the calling
+// process into it. Returns the group, or -1 when every group is in use.
+int
+creategroup(int funding)
+{
+  int group;
+
+  acquire(&ptable.lock);
+  for(group = 1; group < NGROUP; group++){
+    if(!ptable.group[group].inuse){
+      ptable.group[group].inuse = 1;
+      ptable.group[group].funding = funding;
+      ptable.group[group].members = 0;
+      ptable.group[group].shares = 0;
+      ptable.group[group].first = 0;
+      setgroup(myproc(), group);
+      release(&ptable.lock);
+      return group;
+    }
+  }
+  release(&ptable.lock);
+  return -1;
+}
+
+// Move the calling process into an existing group, or with 0 out of its group
+int
+joingroup(int group)
+{
+  acquire(&ptable.lock);
+  if(group < 0 || group >= NGROUP || (group && !ptable.group[group].inuse)){
+    release(&ptable.lock);
+    return -1;
+  }
+  setgroup(myproc(), group);
+  release(&ptable.lock);
+  return 0;
+}
+
+// Change the base tickets backing an existing group
+int
+fundgroup(int group, int funding)
+{
+  acquire(&ptable.lock);
+  if(group <= 0 || group >= NGROUP || !ptable.group[group].inuse){
+    release(&ptable.lock);
+    return -1;
+  }
+  ptable.group[group].funding = funding;
+  groupshares(group, 0, 0);
+  release(&ptable.lock);
+  return 0;
+}
+
+// Map the statistics page read-only into the calling process and return
+// its address. Every slot is updated as its process changes, so polling it
+// takes no lock. fork and exec do not carry the mapping over.
+int
+mapstats(void)
+{
+  if(mapstatspage(myproc()->pgdir, statspage.page) < 0)
+    return -1;
+  return STATSPAGE;
+}
+
+// Start or stop recording scheduling events
+void
+settrace(int on)
+{
+  tracing = on;
+}
+
+// Move up to n recorded events into events, oldest first on each CPU.
+// Returns how many were moved.
+int
+gettrace(struct traceevent *events, int n)
+{
+  struct cpu *c;
+  int count = 0;
+
+  for(c = cpus; c < &cpus[ncpu]; c++){
+    acquire(&c->rqlock);
+    while(count < n && c->trace.tail != c->trace.head)
+      events[count++] = c->trace.event[c->trace.tail++ % TRACESIZE];
+    release(&c->rqlock);
+  }
+  return count;
+}
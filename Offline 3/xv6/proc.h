@@ -1,4 +1,32 @@
 #include "spinlock.h"
+#include "pseudorandom.h"
+#include "trace.h"
+
+// Fenwick tree over the ptable slots holding the tickets of RUNNABLE processes,
+// so that drawing a lottery winner and updating a process both cost O(log NPROC)
+struct ticketree{
+  int tree[NPROC+1];           // 1 based, ptable.proc[i] is at index i+1
+  int total;                   // Sum of the tickets of all runnable processes
+  int size;                    // Number of runnable processes
+};
+
+#define STRIDE1 (1 << 20)       // Stride of a process holding a single ticket
+
+// Min-heap of the runnable processes ordered by pass, used by the stride scheduler
+struct passheap{
+  struct proc *heap[NPROC];
+  int size;
+  int total;                   // Sum of the tickets of all runnable processes
+  uint vtime;                  // Pass of the last process picked, new and woken processes start here
+};
+
+// The latest scheduling events of a CPU, the oldest is overwritten when it is full
+struct tracering{
+  struct traceevent event[TRACESIZE];
+  uint head;                   // Events ever recorded, the next goes to event[head % TRACESIZE]
+  uint tail;                   // First event not drained yet
+};
+
 // Per-CPU state
 struct cpu {
   uchar apicid;                // Local APIC ID
@@ -9,6 +37,18 @@ struct cpu {
   int ncli;                    // Depth of pushcli nesting.
   int intena;                  // Were interrupts enabled before pushcli?
   struct proc *proc;           // The process running on this cpu or null
+
+  struct spinlock rqlock;      // Protects runnable, taken after ptable.lock
+#if STRIDE
+  struct passheap runnable;    // Run queue: runnable processes homed here, by pass
+#else
+  struct ticketree runnable;   // Run queue: tickets of the runnable processes homed here
+#endif
+  uint lastbalance;            // ticks at the last load balancing pass
+  struct rng rng;              // Lottery draws of this CPU, seeded when its scheduler starts
+  struct tracering trace;      // Scheduling events of this CPU, protected by rqlock
+  volatile int idle;           // Halted in idle() with an empty run queue
+  uint64 idlecycles;           // rdtsc cycles spent halted
 };
 
 extern struct cpu cpus[NCPU];
@@ -52,8 +92,22 @@ struct proc {
   char name[16];               // Process name (debugging)
 
   int procTickets;             // Tickets owned by the process, used for scheduling
+  int compTickets;             // Compensation tickets for leaving the last quantum early
+  int usage;                   // Thousandths of the quantum used in the last run
+  int borrowedTickets;         // Tickets lent by processes blocked on this one
+  struct proc *lentTo;         // Process holding this one's tickets while it is blocked, or 0
+  int lentPid;                 // Its pid, the slot may be reused before the tickets come back
+  int lentTickets;             // How many tickets were lent
+  int group;                   // Ticket group the process's tickets are counted in, 0 for none
+  struct proc *groupnext;      // Next member of the same group
+  int queuedweight;            // Tickets the process was put into its run queue with
+  int cpu;                     // Index of the CPU whose run queue holds the process
+  uint pass;                   // Stride scheduler: virtual time of the next run
+  int heapindex;               // Stride scheduler: position in the run queue heap
   int inuse;                   // Information for pstat
   int ticks;                   // Information for pstat
+  uint64 runnablesince;        // TSC when the process last became RUNNABLE while tracing, or 0
+  uint64 runcycles;            // rdtsc cycles the process has run, information for pstat
 };
 
 // Process memory is laid out contiguously, low addresses first:
@@ -63,11 +117,33 @@ struct proc {
 //   expandable heap
 
 
+// A ticket currency. The tickets of the members are worth the group's
+// funding in base tickets, however many members there are.
+struct ticketgroup{
+  int inuse;
+  int funding;                 // Base tickets backing the group
+  int members;                 // Processes in the group, it is freed when the last one leaves
+  int shares;                  // Tickets of the members that are RUNNABLE or RUNNING
+  struct proc *first;          // Members, linked through groupnext
+};
+
 // The struct is moved from proc.c to proc.h to make it available in other files
 struct ptable_info{
   struct spinlock lock;
   struct proc proc[NPROC];
+  struct ticketgroup group[NGROUP]; // group[0] is unused, it stands for the base currency
 };
 
 extern struct ptable_info ptable; // To avoid redeclaration error, declare it on the c file and use extern
-int setticketsutil(struct proc* process, int tickets);
\ No newline at end of file
+int setticketsutil(struct proc* process, int tickets);
+int transferticketsutil(int pid, int tickets);
+void lendtickets(int pid);
+void returntickets(void);
+int basetickets(struct proc* process);
+void setgroup(struct proc* process, int group);
+int creategroup(int funding);
+int joingroup(int group);
+int fundgroup(int group, int funding);
+int mapstats(void);
+void settrace(int on);
+int gettrace(struct traceevent* events, int n);
\ No newline at end of file
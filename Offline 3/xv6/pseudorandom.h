@@ -2,89 +2,59 @@
 #define _PSEUDORANDOM_H
 
 #include "types.h"
-#define SIZE 624
-#define PERIOD 397
-#define M32(x) (0x80000000 & x) // 32nd MSB
-#define L31(x) (0x7FFFFFFF & x) // 31 LSBs
 
-static const int DIFF = SIZE - PERIOD;
-static const uint MAGIC = 0x9908b0df;
+// PCG32 generator (O'Neill, pcg-random.org): 64 bits of state advanced by a
+// linear congruential step, output permuted by a xorshift and a rotation.
+// Every CPU keeps its own in struct cpu, so drawing needs no shared state
+// and costs the same on every call.
+#define PCG_MULTIPLIER 6364136223846793005ULL
 
-struct randomStuff
+struct rng
 {
-    uint MT[SIZE];
-    uint MT_TEMPERED[SIZE];
-    int index;
+    uint64 state;
+    uint64 inc; // Selects the stream, must be odd
 };
 
-static struct randomStuff randomstuff = {.index = SIZE};
-
-#define UNROLL(expr) \
-  y = M32(randomstuff.MT[i]) | L31(randomstuff.MT[i+1]); \
-  randomstuff.MT[i] = randomstuff.MT[expr] ^ (y >> 1) ^ ((((int)y << 31) >> 31) & MAGIC); \
-  ++i;
-  
-void
-GenerateNumbers()
+static inline uint
+rand(struct rng *r)
 {
-  int i = 0;
-  uint y;
-
-  while ( i < DIFF ) {
-    UNROLL(i+PERIOD);
-  }
-
-  while ( i < SIZE -1 ) {
-    UNROLL(i-DIFF);
-  }
+    uint64 old = r->state;
+    uint xorshifted, rot;
 
-  {
-    y = M32(randomstuff.MT[SIZE-1]) | L31(randomstuff.MT[0]);
-    randomstuff.MT[SIZE-1] = randomstuff.MT[PERIOD-1] ^ (y >> 1) ^ ((((int)y << 31) >>
-          31) & MAGIC);
-  }
-
-  // Temper all numbers in a batch
-  for (int i = 0; i < SIZE; ++i) {
-    y = randomstuff.MT[i];
-    y ^= y >> 11;
-    y ^= y << 7  & 0x9d2c5680;
-    y ^= y << 15 & 0xefc60000;
-    y ^= y >> 18;
-    randomstuff.MT_TEMPERED[i] = y;
-  }
-
-  randomstuff.index = 0;
+    r->state = old * PCG_MULTIPLIER + r->inc;
+    xorshifted = ((old >> 18) ^ old) >> 27;
+    rot = old >> 59;
+    return (xorshifted >> rot) | (xorshifted << (-rot & 31));
 }
 
-void
-srand(int newSeed)
+// Generators seeded alike still differ when their streams differ
+static inline void
+srand(struct rng *r, uint64 seed, uint stream)
 {
-    randomstuff.MT[0] = newSeed;
-    randomstuff.index = SIZE;
-
-    for ( uint i=1; i<SIZE; ++i )
-        randomstuff.MT[i] = 0x6c078965*(randomstuff.MT[i-1] ^ randomstuff.MT[i-1]>>30) + i;
+    r->state = 0;
+    r->inc = ((uint64)stream << 1) | 1;
+    rand(r);
+    r->state += seed;
+    rand(r);
 }
 
-int
-rand(void)
+// Uniform in [0, limit), limit > 0.
+// Lemire's multiply and shift: the high half of rand() * limit is the result,
+// and the draws whose low half falls below 2^32 % limit are redrawn, so no
+// value is more likely than another. The modulo is only taken on the rare
+// draws that could be biased.
+static inline uint
+randUpTo(struct rng *r, uint limit)
 {
-    if ( randomstuff.index == SIZE ) {
-        GenerateNumbers();
-        randomstuff.index = 0;
-    }
-    int retVal = randomstuff.MT_TEMPERED[randomstuff.index++];
-    if(retVal < 0){
-        retVal *= (-1);
-    }
-    return retVal;
-}
+    uint64 m = (uint64)rand(r) * limit;
+    uint threshold;
 
-int
-randUpTo(int limit)
-{
-    return rand() % limit;
+    if((uint)m < limit){
+        threshold = -limit % limit;
+        while((uint)m < threshold)
+            m = (uint64)rand(r) * limit;
+    }
+    return m >> 32;
 }
 
-#endif
\ No newline at end of file
+#endif
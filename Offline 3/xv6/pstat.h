@@ -7,5 +7,27 @@ struct pstat {
     int tickets[NPROC]; // the number of tickets this process has
     int pid[NPROC]; // the PID of each process
     int ticks[NPROC]; // the number of ticks each process has accumulated};
+    int compensation[NPROC]; // compensation tickets held until the process next wins
+    int usage[NPROC]; // thousandths of a quantum the process used in its last run
+    int borrowed[NPROC]; // tickets lent to the process by processes blocked on it
+    int group[NPROC]; // ticket group the tickets are counted in, 0 for none
+    int basetickets[NPROC]; // what the tickets are worth in base tickets
+    uint64 runtime[NPROC]; // nanoseconds the process has run, measured with the TSC
+    uint64 idle[NCPU]; // nanoseconds each CPU spent halted with nothing to run
+};
+
+// One process table slot of the page mapped by mapstats().
+// The kernel makes seq odd while it writes the slot, so a reader copies
+// the slot and tries again if seq was odd or changed meanwhile.
+struct pstatslot {
+    volatile uint seq;
+    int pid; // 0 when the slot is unused
+    int tickets; // the number of tickets this process has
+    int state; // enum procstate in proc.h
+    uint64 runtime; // nanoseconds the process has run, measured with the TSC
+};
+
+struct pstatpage {
+    struct pstatslot slot[NPROC];
 };
 #endif // _PSTAT_H_
\ No newline at end of file
@@ -105,6 +105,13 @@ extern int sys_write(void);
 extern int sys_uptime(void);
 extern int sys_settickets(void);
 extern int sys_getpinfo(void);
+extern int sys_transfertickets(void);
+extern int sys_creategroup(void);
+extern int sys_joingroup(void);
+extern int sys_fundgroup(void);
+extern int sys_mapstats(void);
+extern int sys_settrace(void);
+extern int sys_gettrace(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -130,6 +137,13 @@ static int (*syscalls[])(void) = {
 [SYS_close]   sys_close,
 [SYS_settickets] sys_settickets,
 [SYS_getpinfo] sys_getpinfo,
+[SYS_transfertickets] sys_transfertickets,
+[SYS_creategroup] sys_creategroup,
+[SYS_joingroup] sys_joingroup,
+[SYS_fundgroup] sys_fundgroup,
+[SYS_mapstats] sys_mapstats,
+[SYS_settrace] sys_settrace,
+[SYS_gettrace] sys_gettrace,
 };
 
 void
@@ -22,3 +22,10 @@
 #define SYS_close  21
 #define SYS_settickets 22
 #define SYS_getpinfo 23
+#define SYS_transfertickets 24
+#define SYS_creategroup 25
+#define SYS_joingroup 26
+#define SYS_fundgroup 27
+#define SYS_mapstats 28
+#define SYS_settrace 29
+#define SYS_gettrace 30
\ No newline at end of file
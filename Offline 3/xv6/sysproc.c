@@ -97,8 +97,8 @@ int sys_settickets(void)
     return -1;
   }
 
-  // User cannot reduce ticket to 0 or set tickets less than 0
-  if(ticketNumber <= 0){
+  // User cannot reduce ticket to 0 or set tickets less than 0, nor more than MAXTICKETS
+  if(ticketNumber <= 0 || ticketNumber > MAXTICKETS){
     return -1;
   }
   
@@ -106,6 +106,107 @@ int sys_settickets(void)
   return setticketsutil(myproc(), ticketNumber);
 }
 
+// Gives some of the calling process's tickets to another process for good
+int sys_transfertickets(void)
+{
+  int pid, ticketNumber;
+
+  if(argint(0, &pid) < 0 || argint(1, &ticketNumber) < 0)
+  {
+    return -1;
+  }
+
+  // Nothing to give, and the caller must keep at least one ticket
+  if(ticketNumber <= 0){
+    return -1;
+  }
+
+  return transferticketsutil(pid, ticketNumber);
+}
+
+// Creates a ticket group funded with base tickets and moves the calling process into it
+int sys_creategroup(void)
+{
+  int funding;
+
+  if(argint(0, &funding) < 0 || funding <= 0 || funding > MAXTICKETS)
+  {
+    return -1;
+  }
+
+  return creategroup(funding);
+}
+
+// Moves the calling process into a ticket group, 0 leaves its group
+int sys_joingroup(void)
+{
+  int group;
+
+  if(argint(0, &group) < 0)
+  {
+    return -1;
+  }
+
+  return joingroup(group);
+}
+
+// Changes the base tickets backing a ticket group
+int sys_fundgroup(void)
+{
+  int group, funding;
+
+  if(argint(0, &group) < 0 || argint(1, &funding) < 0 || funding <= 0 || funding > MAXTICKETS)
+  {
+    return -1;
+  }
+
+  return fundgroup(group, funding);
+}
+
+// Maps the read-only statistics page into the calling process, returns its address
+int sys_mapstats(void)
+{
+  return mapstats();
+}
+
+// Starts or stops recording scheduling events
+int sys_settrace(void)
+{
+  int on;
+
+  if(argint(0, &on) < 0)
+  {
+    return -1;
+  }
+
+  settrace(on != 0);
+  return 0;
+}
+
+// Drains up to n recorded scheduling events, returns how many were copied
+int sys_gettrace(void)
+{
+  struct traceevent *events;
+  int n;
+
+  if(argint(1, &n) < 0 || n < 0)
+  {
+    return -1;
+  }
+
+  // No more can be recorded, and the size below must not overflow
+  if(n > NCPU * TRACESIZE)
+  {
+    n = NCPU * TRACESIZE;
+  }
+  if(argptr(0, (void *)&events, n * sizeof(*events)) < 0)
+  {
+    return -1;
+  }
+
+  return gettrace(events, n);
+}
+
 // Returns information about processes
 int sys_getpinfo(void)
 {
@@ -134,11 +235,22 @@ int sys_getpinfo(void)
       pstatStructure->inuse[Counter] = process->inuse;
       pstatStructure->tickets[Counter] = process->procTickets;
       pstatStructure->ticks[Counter] = process->ticks;
+      pstatStructure->compensation[Counter] = process->compTickets;
+      pstatStructure->usage[Counter] = process->usage;
+      pstatStructure->borrowed[Counter] = process->borrowedTickets;
+      pstatStructure->group[Counter] = process->group;
+      pstatStructure->basetickets[Counter] = basetickets(process);
+      pstatStructure->runtime[Counter] = cyclestons(process->runcycles);
       Counter++;
     }
   }
   // Work done, release the lock
   release(&ptable.lock);
 
+  for (Counter = 0; Counter < NCPU; Counter++)
+  {
+    pstatStructure->idle[Counter] = Counter < ncpu ? cyclestons(cpus[Counter].idlecycles) : 0;
+  }
+
   return 0;
 }
\ No newline at end of file
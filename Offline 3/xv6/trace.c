@@ -0,0 +1,36 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "trace.h"
+
+// Drains the scheduler trace of every CPU, or turns tracing on or off
+#define BATCH 64
+
+struct traceevent events[BATCH];
+
+int
+main(int argc, char **argv)
+{
+  int i, n;
+
+  if(argc == 2 && strcmp(argv[1], "on") == 0){
+    settrace(1);
+    exit();
+  }
+  if(argc == 2 && strcmp(argv[1], "off") == 0){
+    settrace(0);
+    exit();
+  }
+  if(argc != 1){
+    printf(2, "usage: trace [on|off]\n");
+    exit();
+  }
+
+  printf(1, "time\tcpu\tpid\tticket\ttotal\trunnable\twait\n");
+  while((n = gettrace(events, BATCH)) > 0){
+    for(i = 0; i < n; i++)
+      printf(1, "%d\t%d\t%d\t%d\t%d\t%d\t%d\n", events[i].time, events[i].cpu, events[i].pid,
+             events[i].ticket, events[i].total, events[i].runnable, events[i].wait);
+  }
+  exit();
+}
@@ -0,0 +1,14 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+// A scheduling decision, recorded by the CPU that made it while tracing is on
+struct traceevent {
+    uint time; // microseconds of TSC time when the winner was picked
+    uint wait; // microseconds the winner was RUNNABLE before it was picked
+    int cpu; // the CPU that picked it
+    int pid; // the winner
+    int ticket; // the winning ticket, or the winner's pass with the stride scheduler
+    int total; // tickets in the CPU's run queue
+    int runnable; // processes in the CPU's run queue
+};
+#endif // _TRACE_H_
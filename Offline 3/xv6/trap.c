@@ -13,6 +13,22 @@ struct gatedesc idt[256];
 extern uint vectors[];  // in vectors.S: array of 256 entry pointers
 struct spinlock tickslock;
 uint ticks;
+uint cyclespertick;  // rdtsc cycles between two timer interrupts, measured on the first CPU
+static uint64 lasttickcycles;
+
+// rdtsc cycles in nanoseconds, 0 until the first two ticks have been timed.
+// Splits the cycles into whole ticks and a remainder so nothing overflows.
+uint64
+cyclestons(uint64 cycles)
+{
+  uint perTick = cyclespertick;
+  uint64 wholeTicks;
+
+  if(perTick == 0)
+    return 0;
+  wholeTicks = div64(cycles, perTick);
+  return wholeTicks * TICKNS + div64((cycles - wholeTicks * perTick) * TICKNS, perTick);
+}
 
 void
 tvinit(void)
@@ -50,6 +66,10 @@ trap(struct trapframe *tf)
   case T_IRQ0 + IRQ_TIMER:
     if(cpuid() == 0){
       acquire(&tickslock);
+      uint64 now = rdtsc();
+      if(lasttickcycles)
+        cyclespertick = now - lasttickcycles;
+      lasttickcycles = now;
       ticks++;
       wakeup(&ticks);
       release(&tickslock);
@@ -60,6 +80,10 @@ trap(struct trapframe *tf)
     ideintr();
     lapiceoi();
     break;
+  case T_IRQ0 + IRQ_WAKEUP:
+    // Only there to end the hlt of an idle scheduler
+    lapiceoi();
+    break;
   case T_IRQ0 + IRQ_IDE+1:
     // Bochs generates spurious IDE1 interrupts.
     break;
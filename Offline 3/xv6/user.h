@@ -1,6 +1,8 @@
 struct stat;
 struct rtcdate;
 struct pstat;
+struct pstatpage;
+struct traceevent;
 
 // system calls
 int fork(void);
@@ -26,6 +28,13 @@ int sleep(int);
 int uptime(void);
 int getpinfo(struct pstat *);
 int settickets(int);
+int transfertickets(int, int);
+int creategroup(int);
+int joingroup(int);
+int fundgroup(int, int);
+struct pstatpage* mapstats(void);
+int settrace(int);
+int gettrace(struct traceevent*, int);
 
 // ulib.c
 int stat(const char*, struct stat*);
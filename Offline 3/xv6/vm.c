@@ -224,7 +224,7 @@ allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   char *mem;
   uint a;
 
-  if(newsz >= KERNBASE)
+  if(newsz > STATSPAGE)
     return 0;
   if(newsz < oldsz)
     return oldsz;
@@ -278,15 +278,32 @@ deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   return newsz;
 }
 
+// Map the kernel's statistics page read-only at STATSPAGE.
+// User memory stops below it, so the address is always free.
+int
+mapstatspage(pde_t *pgdir, char *page)
+{
+  pte_t *pte;
+
+  pte = walkpgdir(pgdir, (char*)STATSPAGE, 0);
+  if(pte && (*pte & PTE_P))
+    return 0;
+  return mappages(pgdir, (char*)STATSPAGE, PGSIZE, V2P(page), PTE_U);
+}
+
 // Free a page table and all the physical memory pages
 // in the user part.
 void
 freevm(pde_t *pgdir)
 {
   uint i;
+  pte_t *pte;
 
   if(pgdir == 0)
     panic("freevm: no pgdir");
+  // The statistics page belongs to the kernel, unmap it before the user pages are freed
+  if((pte = walkpgdir(pgdir, (char*)STATSPAGE, 0)) != 0)
+    *pte = 0;
   deallocuvm(pgdir, KERNBASE, 0);
   for(i = 0; i < NPDENTRIES; i++){
     if(pgdir[i] & PTE_P){
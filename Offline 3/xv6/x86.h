@@ -117,6 +117,15 @@ sti(void)
   asm volatile("sti");
 }
 
+// Enable interrupts and halt until the next one. sti takes effect
+// after the following instruction, so an interrupt pending at the
+// sti wakes the hlt instead of being taken before it.
+static inline void
+stihlt(void)
+{
+  asm volatile("sti; hlt");
+}
+
 static inline uint
 xchg(volatile uint *addr, uint newval)
 {
@@ -144,6 +153,30 @@ lcr3(uint val)
   asm volatile("movl %0,%%cr3" : : "r" (val));
 }
 
+// Cycles since the processor was reset
+static inline uint64
+rdtsc(void)
+{
+  uint lo, hi;
+
+  asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
+  return ((uint64)hi << 32) | lo;
+}
+
+// 64 by 32 bit unsigned division, the kernel is not linked
+// with libgcc, which gcc calls for the / of a uint64.
+// The high half is divided first so divl can not overflow.
+static inline uint64
+div64(uint64 n, uint d)
+{
+  uint hi = n >> 32, lo = n, qhi, qlo, r;
+
+  qhi = hi / d;
+  r = hi % d;
+  asm("divl %4" : "=a" (qlo), "=d" (r) : "a" (lo), "d" (r), "rm" (d));
+  return ((uint64)qhi << 32) | qlo;
+}
+
 //PAGEBREAK: 36
 // Layout of the trap frame built on the stack by the
 // hardware and by trapasm.S, and passed to trap().